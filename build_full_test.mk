@@ -16,18 +16,23 @@
 #include $(TMK_PATH)/protocol.mk
 
 TEST_PATH=tests/$(TEST)
+# A test's rules.mk can point these somewhere else, see tests/simulator
+TEST_KEYMAP_C ?= $(TEST_PATH)/keymap.c
+TEST_CONFIG_H ?= $(TEST_PATH)/config.h
 
 $(TEST)_SRC= \
-	$(TEST_PATH)/keymap.c \
+	$(TEST_KEYMAP_C) \
 	$(TMK_COMMON_SRC) \
 	$(QUANTUM_SRC) \
 	$(SRC) \
 	tests/test_common/matrix.c \
 	tests/test_common/test_driver.cpp \
 	tests/test_common/keyboard_report_util.cpp \
-	tests/test_common/test_fixture.cpp
+	tests/test_common/test_fixture.cpp \
+	tests/test_common/trace_replay.cpp
 $(TEST)_SRC += $(patsubst $(ROOTDIR)/%,%,$(wildcard $(TEST_PATH)/*.cpp))
 
 $(TEST)_DEFS=$(TMK_COMMON_DEFS) $(OPT_DEFS)
-$(TEST)_CONFIG=$(TEST_PATH)/config.h
+$(TEST)_CONFIG=$(TEST_CONFIG_H)
 VPATH+=$(TOP_DIR)/tests/test_common
+VPATH+=$(TOP_DIR)/$(TEST_PATH)
@@ -83,7 +83,7 @@ ifeq ($(strip $(POINTING_DEVICE_ENABLE)), yes)
     SRC += $(QUANTUM_DIR)/pointing_device.c
 endif
 
-VALID_EEPROM_DRIVER_TYPES := vendor custom transient i2c spi
+VALID_EEPROM_DRIVER_TYPES := vendor custom transient i2c spi wear_leveling
 EEPROM_DRIVER ?= vendor
 ifeq ($(filter $(EEPROM_DRIVER),$(VALID_EEPROM_DRIVER_TYPES)),)
   $(error EEPROM_DRIVER="$(EEPROM_DRIVER)" is not a valid EEPROM driver)
@@ -107,6 +107,29 @@ else
     OPT_DEFS += -DEEPROM_DRIVER -DEEPROM_TRANSIENT
     COMMON_VPATH += $(DRIVER_PATH)/eeprom
     SRC += eeprom_driver.c eeprom_transient.c
+  else ifeq ($(strip $(EEPROM_DRIVER)), wear_leveling)
+    OPT_DEFS += -DEEPROM_DRIVER -DEEPROM_WEAR_LEVELING
+    COMMON_VPATH += $(DRIVER_PATH)/eeprom
+    SRC += eeprom_driver.c eeprom_wear_leveling.c
+    ifeq ($(PLATFORM),CHIBIOS)
+      ifeq ($(MCU_SERIES), STM32F3xx)
+        OPT_DEFS += -DEEPROM_EMU_STM32F303xC
+      else ifeq ($(MCU_SERIES), STM32F1xx)
+        OPT_DEFS += -DEEPROM_EMU_STM32F103xB
+      else ifeq ($(MCU_SERIES)_$(MCU_LDSCRIPT), STM32F0xx_STM32F072xB)
+        OPT_DEFS += -DEEPROM_EMU_STM32F072xB
+      else ifeq ($(MCU_SERIES)_$(MCU_LDSCRIPT), STM32F0xx_STM32F042x6)
+        OPT_DEFS += -DEEPROM_EMU_STM32F042x6
+      else
+        $(error EEPROM_DRIVER=wear_leveling is not supported on MCU_SERIES="$(MCU_SERIES)")
+      endif
+      SRC += $(PLATFORM_COMMON_DIR)/flash_stm32.c
+      SRC += eeprom_wear_leveling_stm32.c
+    else ifeq ($(PLATFORM),TEST)
+      SRC += eeprom_wear_leveling_sim.c
+    else
+      $(error EEPROM_DRIVER=wear_leveling is not supported on PLATFORM="$(PLATFORM)")
+    endif
   else ifeq ($(strip $(EEPROM_DRIVER)), vendor)
     OPT_DEFS += -DEEPROM_VENDOR
     ifeq ($(PLATFORM),AVR)
@@ -369,6 +392,7 @@ ifeq ($(strip $(USB_HID_ENABLE)), yes)
 endif
 
 ifeq ($(strip $(WPM_ENABLE)), yes)
+    DEFERRED_EXEC_ENABLE := yes
     SRC += $(QUANTUM_DIR)/wpm.c
     OPT_DEFS += -DWPM_ENABLE
 endif
@@ -451,7 +475,12 @@ ifeq ($(strip $(SPLIT_KEYBOARD)), yes)
 
     # Determine which (if any) transport files are required
     ifneq ($(strip $(SPLIT_TRANSPORT)), custom)
-        QUANTUM_SRC += $(QUANTUM_DIR)/split_common/transport.c
+        ifeq ($(strip $(SPLIT_TRANSPORT)), delta)
+            OPT_DEFS += -DSPLIT_TRANSPORT_DELTA
+            QUANTUM_SRC += $(QUANTUM_DIR)/split_common/transport_delta.c
+        else
+            QUANTUM_SRC += $(QUANTUM_DIR)/split_common/transport.c
+        endif
         # Functions added via QUANTUM_LIB_SRC are only included in the final binary if they're called.
         # Unused functions are pruned away, which is why we can add multiple drivers here without bloat.
         ifeq ($(PLATFORM),AVR)
@@ -468,6 +497,9 @@ ifeq ($(strip $(SPLIT_KEYBOARD)), yes)
         else
             QUANTUM_LIB_SRC += serial_$(strip $(SERIAL_DRIVER)).c
         endif
+        ifeq ($(strip $(SERIAL_DRIVER)), usart)
+            QUANTUM_LIB_SRC += serial_async.c
+        endif
     endif
     COMMON_VPATH += $(QUANTUM_PATH)/split_common
 endif
@@ -555,6 +587,7 @@ ifeq ($(strip $(COMBO_ENABLE)), yes)
 endif
 
 ifeq ($(strip $(TAP_DANCE_ENABLE)), yes)
+    DEFERRED_EXEC_ENABLE := yes
     SRC += $(QUANTUM_DIR)/process_keycode/process_tap_dance.c
     OPT_DEFS += -DTAP_DANCE_ENABLE
 endif
@@ -570,6 +603,7 @@ ifeq ($(strip $(LEADER_ENABLE)), yes)
 endif
 
 ifeq ($(strip $(AUTO_SHIFT_ENABLE)), yes)
+    DEFERRED_EXEC_ENABLE := yes
     SRC += $(QUANTUM_DIR)/process_keycode/process_auto_shift.c
     OPT_DEFS += -DAUTO_SHIFT_ENABLE
     ifeq ($(strip $(AUTO_SHIFT_MODIFIERS)), yes)
@@ -577,6 +611,11 @@ ifeq ($(strip $(AUTO_SHIFT_ENABLE)), yes)
     endif
 endif
 
+ifeq ($(strip $(DEFERRED_EXEC_ENABLE)), yes)
+    SRC += $(QUANTUM_DIR)/deferred_exec.c
+    OPT_DEFS += -DDEFERRED_EXEC_ENABLE
+endif
+
 JOYSTICK_ENABLE ?= no
 ifneq ($(strip $(JOYSTICK_ENABLE)), no)
     OPT_DEFS += -DJOYSTICK_ENABLE
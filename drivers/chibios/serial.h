@@ -47,6 +47,16 @@ int soft_serial_transaction(void);
 int soft_serial_transaction(int sstd_index);
 #endif
 
+#ifdef SERIAL_USE_ASYNC_TRANSACTION
+// transaction still running
+#    define TRANSACTION_BUSY 0x10
+// Starts a transaction without waiting for it, returns false if one is already running
+bool soft_serial_transaction_start(int sstd_index);
+// Moves the running transaction forward, returns TRANSACTION_BUSY until it's done,
+// then the result of the last transaction
+int soft_serial_transaction_poll(void);
+#endif
+
 // target status
 // *SSTD_t.status has
 //   initiator:
@@ -91,6 +91,36 @@ static inline void sdClear(SerialDriver* driver) {
     }
 }
 
+#ifdef SERIAL_USE_ASYNC_TRANSACTION
+#    include "serial_async.h"
+
+// Bytes we wrote that the half duplex line still has to give back
+static uint8_t async_echo = 0;
+
+void serial_async_phy_clear(void) {
+    sdClear(&SERIAL_USART_DRIVER);
+    async_echo = 0;
+}
+
+uint8_t serial_async_phy_write(const uint8_t* data, uint8_t size) {
+    uint8_t written = sdAsynchronousWrite(&SERIAL_USART_DRIVER, data, size);
+    async_echo += written;
+    return written;
+}
+
+uint8_t serial_async_phy_read(uint8_t* data, uint8_t size) {
+    while (async_echo) {
+        uint8_t dump[8];
+        uint8_t n = sdAsynchronousRead(&SERIAL_USART_DRIVER, dump, async_echo < sizeof(dump) ? async_echo : sizeof(dump));
+        if (n == 0) {
+            return 0;
+        }
+        async_echo -= n;
+    }
+    return sdAsynchronousRead(&SERIAL_USART_DRIVER, data, size);
+}
+#endif
+
 static SerialConfig sdcfg = {
     (SERIAL_USART_SPEED),  // speed - mandatory
     (SERIAL_USART_CR1),    // CR1
@@ -146,6 +176,9 @@ void soft_serial_initiator_init(SSTD_t* sstd_table, int sstd_table_size) {
     Transaction_table      = sstd_table;
     Transaction_table_size = (uint8_t)sstd_table_size;
 
+#ifdef SERIAL_USE_ASYNC_TRANSACTION
+    serial_async_init(sstd_table, sstd_table_size);
+#endif
     usart_master_init();
 }
 
@@ -0,0 +1,180 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "eeprom_driver.h"
+#include "eeprom_wear_leveling.h"
+
+/*
+    Bank layout:
+        header     : magic, generation
+        image      : WEAR_LEVELING_EEPROM_SIZE bytes, written on compaction
+        log        : 4-byte entries of address, value | ~value << 8
+
+    The header is programmed last when compacting, so a bank only becomes valid
+    once its image is complete. Both banks are usually valid, the newer generation wins.
+    The inverted copy of the value means an entry whose second halfword was never
+    programmed (power loss) is detected and skipped.
+*/
+#define WEAR_LEVELING_MAGIC 0x574C
+#define WEAR_LEVELING_EMPTY 0xFFFF
+
+static uint8_t  wear_leveling_cache[WEAR_LEVELING_EEPROM_SIZE];
+static uint8_t  wear_leveling_bank       = 0;
+static uint16_t wear_leveling_generation = 0;
+static uint32_t wear_leveling_log_offset = WEAR_LEVELING_LOG_OFFSET;
+
+static inline uint32_t bank_base(uint8_t bank) { return (uint32_t)bank * WEAR_LEVELING_BANK_SIZE; }
+
+static inline bool bank_is_valid(uint8_t bank) { return backing_store_read(bank_base(bank)) == WEAR_LEVELING_MAGIC; }
+
+static inline uint16_t bank_generation(uint8_t bank) { return backing_store_read(bank_base(bank) + 2); }
+
+static inline uint16_t entry_value(uint8_t value) { return value | ((uint16_t)(uint8_t)~value << 8); }
+
+static inline bool entry_is_valid(uint16_t value) { return (uint8_t)(value >> 8) == (uint8_t)~value; }
+
+/*
+    Writes the RAM copy as the image of the inactive bank and makes it the active one.
+*/
+static void wear_leveling_compact(void) {
+    uint8_t  next = wear_leveling_bank ^ 1;
+    uint32_t base = bank_base(next);
+
+    backing_store_erase(base, WEAR_LEVELING_BANK_SIZE);
+    for (uint16_t i = 0; i < WEAR_LEVELING_EEPROM_SIZE; i += 2) {
+        uint16_t value = wear_leveling_cache[i] | ((uint16_t)wear_leveling_cache[i + 1] << 8);
+        // Erased flash already reads back as 0xFF
+        if (value != WEAR_LEVELING_EMPTY) {
+            backing_store_write(base + WEAR_LEVELING_HEADER_SIZE + i, value);
+        }
+    }
+    wear_leveling_generation++;
+    backing_store_write(base + 2, wear_leveling_generation);
+    backing_store_write(base, WEAR_LEVELING_MAGIC);
+
+    // The old bank is left as is, it is erased when it becomes the target of the next compaction
+    wear_leveling_bank       = next;
+    wear_leveling_log_offset = WEAR_LEVELING_LOG_OFFSET;
+}
+
+/*
+    Rebuilds the RAM copy from the image and the log of the active bank.
+*/
+static void wear_leveling_replay(void) {
+    uint32_t base = bank_base(wear_leveling_bank);
+
+    for (uint16_t i = 0; i < WEAR_LEVELING_EEPROM_SIZE; i += 2) {
+        uint16_t value             = backing_store_read(base + WEAR_LEVELING_HEADER_SIZE + i);
+        wear_leveling_cache[i]     = value & 0xFF;
+        wear_leveling_cache[i + 1] = value >> 8;
+    }
+
+    uint32_t offset = WEAR_LEVELING_LOG_OFFSET;
+    while (offset + WEAR_LEVELING_ENTRY_SIZE <= WEAR_LEVELING_BANK_SIZE) {
+        uint16_t address = backing_store_read(base + offset);
+        if (address == WEAR_LEVELING_EMPTY) {
+            break;
+        }
+        uint16_t value = backing_store_read(base + offset + 2);
+        if (entry_is_valid(value) && address < WEAR_LEVELING_EEPROM_SIZE) {
+            wear_leveling_cache[address] = value & 0xFF;
+        }
+        offset += WEAR_LEVELING_ENTRY_SIZE;
+    }
+    wear_leveling_log_offset = offset;
+}
+
+static void wear_leveling_format(void) {
+    backing_store_unlock();
+    backing_store_erase(0, WEAR_LEVELING_BACKING_SIZE);
+    memset(wear_leveling_cache, 0xFF, sizeof(wear_leveling_cache));
+    wear_leveling_bank       = 0;
+    wear_leveling_generation = 0;
+    wear_leveling_log_offset = WEAR_LEVELING_LOG_OFFSET;
+    backing_store_write(2, wear_leveling_generation);
+    backing_store_write(0, WEAR_LEVELING_MAGIC);
+    backing_store_lock();
+}
+
+void eeprom_driver_init(void) {
+    backing_store_init();
+
+    bool valid0 = bank_is_valid(0);
+    bool valid1 = bank_is_valid(1);
+    if (!valid0 && !valid1) {
+        wear_leveling_format();
+        return;
+    }
+
+    if (valid0 && valid1) {
+        wear_leveling_bank = (int16_t)(bank_generation(1) - bank_generation(0)) > 0 ? 1 : 0;
+    } else {
+        wear_leveling_bank = valid1 ? 1 : 0;
+    }
+    wear_leveling_generation = bank_generation(wear_leveling_bank);
+    wear_leveling_replay();
+}
+
+void eeprom_driver_erase(void) { wear_leveling_format(); }
+
+void eeprom_read_block(void *buf, const void *addr, size_t len) {
+    uintptr_t offset = (uintptr_t)addr;
+    memset(buf, 0x00, len);
+    if (offset >= WEAR_LEVELING_EEPROM_SIZE) {
+        return;
+    }
+    if (offset + len > WEAR_LEVELING_EEPROM_SIZE) {
+        len = WEAR_LEVELING_EEPROM_SIZE - offset;
+    }
+    memcpy(buf, &wear_leveling_cache[offset], len);
+}
+
+void eeprom_write_block(const void *buf, void *addr, size_t len) {
+    uintptr_t      offset = (uintptr_t)addr;
+    const uint8_t *source = (const uint8_t *)buf;
+    bool           locked = true;
+
+    for (size_t i = 0; i < len && offset + i < WEAR_LEVELING_EEPROM_SIZE; i++) {
+        uint16_t address = offset + i;
+        // Unchanged bytes don't need a log entry
+        if (wear_leveling_cache[address] == source[i]) {
+            continue;
+        }
+        if (locked) {
+            backing_store_unlock();
+            locked = false;
+        }
+
+        wear_leveling_cache[address] = source[i];
+        if (wear_leveling_log_offset + WEAR_LEVELING_ENTRY_SIZE > WEAR_LEVELING_BANK_SIZE) {
+            // The new image already contains this byte
+            wear_leveling_compact();
+            continue;
+        }
+
+        uint32_t entry = bank_base(wear_leveling_bank) + wear_leveling_log_offset;
+        backing_store_write(entry, address);
+        backing_store_write(entry + 2, entry_value(source[i]));
+        wear_leveling_log_offset += WEAR_LEVELING_ENTRY_SIZE;
+    }
+
+    if (!locked) {
+        backing_store_lock();
+    }
+}
@@ -0,0 +1,79 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+    The logical size of the emulated EEPROM, in bytes. A copy of it is kept in RAM.
+*/
+#ifndef WEAR_LEVELING_EEPROM_SIZE
+#    define WEAR_LEVELING_EEPROM_SIZE 1024
+#endif
+
+/*
+    The size of the flash area backing the EEPROM, in bytes. It is split in two banks,
+    each holding a compacted image of the EEPROM followed by a log of byte writes.
+    Only one bank is active at a time; the other one receives the next compacted image
+    once the log of the active bank is full.
+*/
+#ifndef WEAR_LEVELING_BACKING_SIZE
+#    define WEAR_LEVELING_BACKING_SIZE 8192
+#endif
+
+/*
+    The erase granularity of the backing store, in bytes. Banks must be a multiple of it.
+*/
+#ifndef WEAR_LEVELING_FLASH_PAGE_SIZE
+#    if defined(EEPROM_EMU_STM32F303xC) || defined(EEPROM_EMU_STM32F072xB)
+#        define WEAR_LEVELING_FLASH_PAGE_SIZE 2048
+#    else
+#        define WEAR_LEVELING_FLASH_PAGE_SIZE 1024
+#    endif
+#endif
+
+#define WEAR_LEVELING_BANK_SIZE (WEAR_LEVELING_BACKING_SIZE / 2)
+#define WEAR_LEVELING_HEADER_SIZE 4
+#define WEAR_LEVELING_ENTRY_SIZE 4
+#define WEAR_LEVELING_LOG_OFFSET (WEAR_LEVELING_HEADER_SIZE + WEAR_LEVELING_EEPROM_SIZE)
+#define WEAR_LEVELING_LOG_ENTRIES ((WEAR_LEVELING_BANK_SIZE - WEAR_LEVELING_LOG_OFFSET) / WEAR_LEVELING_ENTRY_SIZE)
+
+#if WEAR_LEVELING_EEPROM_SIZE % 2 != 0
+#    error WEAR_LEVELING_EEPROM_SIZE must be a multiple of 2
+#endif
+#if WEAR_LEVELING_EEPROM_SIZE >= 0xFFFF
+#    error WEAR_LEVELING_EEPROM_SIZE must be less than 65535
+#endif
+#if WEAR_LEVELING_BANK_SIZE % WEAR_LEVELING_FLASH_PAGE_SIZE != 0
+#    error WEAR_LEVELING_BACKING_SIZE must be a multiple of two flash pages
+#endif
+#if WEAR_LEVELING_LOG_ENTRIES < 16
+#    error WEAR_LEVELING_BACKING_SIZE is too small to hold two copies of WEAR_LEVELING_EEPROM_SIZE and a write log
+#endif
+
+/*
+    Backing store interface, implemented once per platform.
+    Offsets are relative to the start of the backing area and halfword aligned.
+    Programming is only expected to work on erased (0xFFFF) halfwords.
+*/
+bool     backing_store_init(void);
+bool     backing_store_unlock(void);
+bool     backing_store_erase(uint32_t offset, uint32_t length);
+bool     backing_store_write(uint32_t offset, uint16_t value);
+bool     backing_store_lock(void);
+uint16_t backing_store_read(uint32_t offset);
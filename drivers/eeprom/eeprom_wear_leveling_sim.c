@@ -0,0 +1,72 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "eeprom_wear_leveling_sim.h"
+
+static uint16_t backing_store[WEAR_LEVELING_BACKING_SIZE / 2];
+static bool     backing_store_locked = true;
+
+backing_store_sim_stats_t backing_store_sim_stats;
+
+void backing_store_sim_reset(void) {
+    memset(backing_store, 0xFF, sizeof(backing_store));
+    backing_store_locked = true;
+    backing_store_sim_clear_stats();
+}
+
+void backing_store_sim_clear_stats(void) { memset(&backing_store_sim_stats, 0, sizeof(backing_store_sim_stats)); }
+
+uint16_t *backing_store_sim_data(void) { return backing_store; }
+
+bool backing_store_init(void) { return true; }
+
+bool backing_store_unlock(void) {
+    backing_store_locked = false;
+    return true;
+}
+
+bool backing_store_lock(void) {
+    backing_store_locked = true;
+    return true;
+}
+
+bool backing_store_erase(uint32_t offset, uint32_t length) {
+    if (backing_store_locked || offset % WEAR_LEVELING_FLASH_PAGE_SIZE != 0 || length % WEAR_LEVELING_FLASH_PAGE_SIZE != 0 || offset + length > WEAR_LEVELING_BACKING_SIZE) {
+        backing_store_sim_stats.write_errors++;
+        return false;
+    }
+    for (uint32_t page = offset / WEAR_LEVELING_FLASH_PAGE_SIZE; page < (offset + length) / WEAR_LEVELING_FLASH_PAGE_SIZE; page++) {
+        memset(&backing_store[page * WEAR_LEVELING_FLASH_PAGE_SIZE / 2], 0xFF, WEAR_LEVELING_FLASH_PAGE_SIZE);
+        backing_store_sim_stats.erases++;
+        backing_store_sim_stats.page_erases[page]++;
+    }
+    return true;
+}
+
+bool backing_store_write(uint32_t offset, uint16_t value) {
+    if (backing_store_locked || offset % 2 != 0 || offset >= WEAR_LEVELING_BACKING_SIZE || backing_store[offset / 2] != 0xFFFF) {
+        backing_store_sim_stats.write_errors++;
+        return false;
+    }
+    backing_store[offset / 2] = value;
+    backing_store_sim_stats.writes++;
+    return true;
+}
+
+uint16_t backing_store_read(uint32_t offset) { return offset < WEAR_LEVELING_BACKING_SIZE ? backing_store[offset / 2] : 0xFFFF; }
@@ -0,0 +1,42 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "eeprom_wear_leveling.h"
+
+#define WEAR_LEVELING_SIM_PAGES (WEAR_LEVELING_BACKING_SIZE / WEAR_LEVELING_FLASH_PAGE_SIZE)
+
+/*
+    Host-side backing store. Counts every flash operation so tests can check
+    the wear and the amount of flash traffic caused by EEPROM writes.
+*/
+typedef struct {
+    uint32_t writes;                                // programmed halfwords
+    uint32_t erases;                                // erased pages
+    uint32_t page_erases[WEAR_LEVELING_SIM_PAGES];  // erases per page
+    uint32_t write_errors;                          // programming of non-erased halfwords, or while locked
+} backing_store_sim_stats_t;
+
+extern backing_store_sim_stats_t backing_store_sim_stats;
+
+// Erases the whole simulated flash, as if the chip was freshly programmed
+void backing_store_sim_reset(void);
+void backing_store_sim_clear_stats(void);
+// Direct access to the simulated flash, e.g. to emulate a write torn by power loss
+uint16_t *backing_store_sim_data(void);
@@ -0,0 +1,65 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <hal.h>
+#include "flash_stm32.h"
+#include "eeprom_wear_leveling.h"
+
+/*
+    The backing area defaults to the top of flash, like the vendor flash emulation.
+*/
+#ifndef WEAR_LEVELING_MCU_FLASH_SIZE
+#    if defined(EEPROM_EMU_STM32F303xC)
+#        define WEAR_LEVELING_MCU_FLASH_SIZE 256  // Size in Kb
+#    elif defined(EEPROM_EMU_STM32F103xB) || defined(EEPROM_EMU_STM32F072xB)
+#        define WEAR_LEVELING_MCU_FLASH_SIZE 128  // Size in Kb
+#    elif defined(EEPROM_EMU_STM32F042x6)
+#        define WEAR_LEVELING_MCU_FLASH_SIZE 32  // Size in Kb
+#    else
+#        error "No flash size known for this MCU, please define WEAR_LEVELING_MCU_FLASH_SIZE"
+#    endif
+#endif
+
+#ifndef WEAR_LEVELING_BACKING_BASE_ADDRESS
+#    define WEAR_LEVELING_BACKING_BASE_ADDRESS ((uint32_t)(0x8000000 + WEAR_LEVELING_MCU_FLASH_SIZE * 1024 - WEAR_LEVELING_BACKING_SIZE))
+#endif
+
+bool backing_store_init(void) { return true; }
+
+bool backing_store_unlock(void) {
+    FLASH_Unlock();
+    return true;
+}
+
+bool backing_store_lock(void) {
+    FLASH_Lock();
+    return true;
+}
+
+bool backing_store_erase(uint32_t offset, uint32_t length) {
+    bool ok = true;
+    for (uint32_t page = offset; page < offset + length; page += WEAR_LEVELING_FLASH_PAGE_SIZE) {
+        ok &= FLASH_ErasePage(WEAR_LEVELING_BACKING_BASE_ADDRESS + page) == FLASH_COMPLETE;
+    }
+    return ok;
+}
+
+bool backing_store_write(uint32_t offset, uint16_t value) { return FLASH_ProgramHalfWord(WEAR_LEVELING_BACKING_BASE_ADDRESS + offset, value) == FLASH_COMPLETE; }
+
+uint16_t backing_store_read(uint32_t offset) { return *(__IO uint16_t *)(WEAR_LEVELING_BACKING_BASE_ADDRESS + offset); }
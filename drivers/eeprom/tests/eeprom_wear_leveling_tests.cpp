@@ -0,0 +1,175 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <iostream>
+
+extern "C" {
+#include "eeprom_driver.h"
+#include "eeprom_wear_leveling_sim.h"
+}
+
+class EepromWearLeveling : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        backing_store_sim_reset();
+        eeprom_driver_init();
+        backing_store_sim_clear_stats();
+    }
+
+    uint8_t *ptr(uintptr_t address) { return (uint8_t *)address; }
+};
+
+TEST_F(EepromWearLeveling, FreshStoreReadsAsErased) {
+    for (uintptr_t i = 0; i < WEAR_LEVELING_EEPROM_SIZE; i++) {
+        EXPECT_EQ(eeprom_read_byte(ptr(i)), 0xFF);
+    }
+}
+
+TEST_F(EepromWearLeveling, WritesSurviveReinit) {
+    uint8_t data[] = {0x12, 0x34, 0x56, 0x78, 0x00, 0xFF, 0xAA};
+    eeprom_write_block(data, ptr(10), sizeof(data));
+    eeprom_write_byte(ptr(0), 0x42);
+    eeprom_write_byte(ptr(0), 0x43);
+
+    eeprom_driver_init();
+
+    uint8_t read[sizeof(data)];
+    eeprom_read_block(read, ptr(10), sizeof(read));
+    EXPECT_EQ(memcmp(data, read, sizeof(data)), 0);
+    EXPECT_EQ(eeprom_read_byte(ptr(0)), 0x43);
+    EXPECT_EQ(backing_store_sim_stats.write_errors, 0u);
+}
+
+TEST_F(EepromWearLeveling, EachChangedByteIsOneAppend) {
+    eeprom_write_dword((uint32_t *)ptr(4), 0x11223344);
+    EXPECT_EQ(backing_store_sim_stats.writes, 4u * 2);
+    EXPECT_EQ(backing_store_sim_stats.erases, 0u);
+
+    backing_store_sim_clear_stats();
+    eeprom_write_dword((uint32_t *)ptr(4), 0x11223355);
+    EXPECT_EQ(backing_store_sim_stats.writes, 2u);
+}
+
+TEST_F(EepromWearLeveling, UnchangedBytesAreNotWritten) {
+    eeprom_write_word((uint16_t *)ptr(20), 0xBEEF);
+    backing_store_sim_clear_stats();
+    eeprom_update_word((uint16_t *)ptr(20), 0xBEEF);
+    eeprom_write_word((uint16_t *)ptr(20), 0xBEEF);
+    EXPECT_EQ(backing_store_sim_stats.writes, 0u);
+}
+
+TEST_F(EepromWearLeveling, OutOfRangeAccessIsClamped) {
+    uint8_t data[4] = {1, 2, 3, 4};
+    eeprom_write_block(data, ptr(WEAR_LEVELING_EEPROM_SIZE - 2), sizeof(data));
+    uint8_t read[4];
+    eeprom_read_block(read, ptr(WEAR_LEVELING_EEPROM_SIZE - 2), sizeof(read));
+    EXPECT_EQ(read[0], 1);
+    EXPECT_EQ(read[1], 2);
+    EXPECT_EQ(read[2], 0);
+    EXPECT_EQ(read[3], 0);
+    EXPECT_EQ(backing_store_sim_stats.write_errors, 0u);
+}
+
+TEST_F(EepromWearLeveling, CompactsOnlyWhenLogIsFull) {
+    for (unsigned i = 0; i < WEAR_LEVELING_LOG_ENTRIES; i++) {
+        eeprom_write_byte(ptr(i % WEAR_LEVELING_EEPROM_SIZE), i);
+    }
+    EXPECT_EQ(backing_store_sim_stats.erases, 0u);
+
+    eeprom_write_byte(ptr(0), 0x99);
+    EXPECT_EQ(backing_store_sim_stats.erases, (unsigned)(WEAR_LEVELING_BANK_SIZE / WEAR_LEVELING_FLASH_PAGE_SIZE));
+
+    eeprom_driver_init();
+    EXPECT_EQ(eeprom_read_byte(ptr(0)), 0x99);
+    for (unsigned i = WEAR_LEVELING_LOG_ENTRIES - WEAR_LEVELING_EEPROM_SIZE; i < WEAR_LEVELING_LOG_ENTRIES; i++) {
+        if (i % WEAR_LEVELING_EEPROM_SIZE == 0) continue;
+        EXPECT_EQ(eeprom_read_byte(ptr(i % WEAR_LEVELING_EEPROM_SIZE)), (uint8_t)i);
+    }
+    EXPECT_EQ(backing_store_sim_stats.write_errors, 0u);
+}
+
+TEST_F(EepromWearLeveling, WearIsSpreadOverAllPages) {
+    for (unsigned i = 0; i < 20000; i++) {
+        eeprom_write_byte(ptr(i % 7), i);
+    }
+    uint32_t min = UINT32_MAX, max = 0;
+    for (unsigned page = 0; page < WEAR_LEVELING_SIM_PAGES; page++) {
+        min = std::min(min, backing_store_sim_stats.page_erases[page]);
+        max = std::max(max, backing_store_sim_stats.page_erases[page]);
+    }
+    EXPECT_LE(max - min, 1u);
+
+    eeprom_driver_init();
+    for (unsigned i = 20000 - 7; i < 20000; i++) {
+        EXPECT_EQ(eeprom_read_byte(ptr(i % 7)), (uint8_t)i);
+    }
+    EXPECT_EQ(backing_store_sim_stats.write_errors, 0u);
+}
+
+TEST_F(EepromWearLeveling, TornLogEntryIsIgnored) {
+    eeprom_write_byte(ptr(3), 0x33);
+
+    // Power lost after programming the address of the next entry, but not its value
+    uint16_t *flash = backing_store_sim_data();
+    flash[(WEAR_LEVELING_LOG_OFFSET + WEAR_LEVELING_ENTRY_SIZE) / 2] = 5;
+
+    eeprom_driver_init();
+    EXPECT_EQ(eeprom_read_byte(ptr(3)), 0x33);
+    EXPECT_EQ(eeprom_read_byte(ptr(5)), 0xFF);
+
+    eeprom_write_byte(ptr(5), 0x55);
+    eeprom_driver_init();
+    EXPECT_EQ(eeprom_read_byte(ptr(5)), 0x55);
+    EXPECT_EQ(backing_store_sim_stats.write_errors, 0u);
+}
+
+TEST_F(EepromWearLeveling, InterruptedCompactionKeepsOldBank) {
+    for (unsigned i = 0; i < WEAR_LEVELING_LOG_ENTRIES; i++) {
+        eeprom_write_byte(ptr(i % WEAR_LEVELING_EEPROM_SIZE), 0x10 + (i % 2));
+    }
+    uint8_t expected = eeprom_read_byte(ptr(0));
+
+    // Bank 1 erased and partially written, but its header never programmed
+    uint16_t *flash = backing_store_sim_data();
+    flash[(WEAR_LEVELING_BANK_SIZE + WEAR_LEVELING_HEADER_SIZE) / 2] = 0x0000;
+
+    eeprom_driver_init();
+    EXPECT_EQ(eeprom_read_byte(ptr(0)), expected);
+    eeprom_write_byte(ptr(0), 0x77);
+    eeprom_driver_init();
+    EXPECT_EQ(eeprom_read_byte(ptr(0)), 0x77);
+    EXPECT_EQ(eeprom_read_byte(ptr(1)), 0x11);
+    EXPECT_EQ(backing_store_sim_stats.write_errors, 0u);
+}
+
+TEST_F(EepromWearLeveling, EraseResetsToErasedState) {
+    eeprom_write_byte(ptr(1), 0x01);
+    eeprom_driver_erase();
+    EXPECT_EQ(eeprom_read_byte(ptr(1)), 0xFF);
+    eeprom_driver_init();
+    EXPECT_EQ(eeprom_read_byte(ptr(1)), 0xFF);
+}
+
+TEST_F(EepromWearLeveling, FlashTrafficPerUpdate) {
+    const unsigned updates = 10000;
+    for (unsigned i = 0; i < updates; i++) {
+        eeprom_update_byte(ptr(i % WEAR_LEVELING_EEPROM_SIZE), i * 7);
+    }
+    std::cout << updates << " byte updates: " << backing_store_sim_stats.writes << " halfword writes, " << backing_store_sim_stats.erases << " page erases" << std::endl;
+    // A page-rewriting emulation needs a page erase for every overwrite of a used byte
+    EXPECT_LT(backing_store_sim_stats.erases, updates / 10);
+}
@@ -0,0 +1,13 @@
+eeprom_wear_leveling_DEFS := \
+	-DWEAR_LEVELING_EEPROM_SIZE=64 \
+	-DWEAR_LEVELING_BACKING_SIZE=1024 \
+	-DWEAR_LEVELING_FLASH_PAGE_SIZE=256
+
+eeprom_wear_leveling_INC := \
+	$(DRIVER_PATH)/eeprom
+
+eeprom_wear_leveling_SRC := \
+	$(DRIVER_PATH)/eeprom/tests/eeprom_wear_leveling_tests.cpp \
+	$(DRIVER_PATH)/eeprom/eeprom_driver.c \
+	$(DRIVER_PATH)/eeprom/eeprom_wear_leveling.c \
+	$(DRIVER_PATH)/eeprom/eeprom_wear_leveling_sim.c
@@ -73,8 +73,10 @@ uint8_t g_twi_transfer_buffer[20] = {0xFF};
 // buffers and the transfers in IS31FL3741_write_pwm_buffer() but it's
 // probably not worth the extra complexity.
 uint8_t g_pwm_buffer[DRIVER_COUNT][ISSI_MAX_LEDS];
-bool    g_pwm_buffer_update_required                      = false;
-bool    g_scaling_registers_update_required[DRIVER_COUNT] = {false};
+// One bit per 18 byte block of the PWM buffer, set when the block has changed
+// since it was last sent to the driver.
+uint32_t g_pwm_buffer_dirty                                = 0;
+bool     g_scaling_registers_update_required[DRIVER_COUNT] = {false};
 
 uint8_t g_scaling_registers[DRIVER_COUNT][ISSI_MAX_LEDS];
 
@@ -91,46 +93,29 @@ void IS31FL3741_write_register(uint8_t addr, uint8_t reg, uint8_t data) {
 #endif
 }
 
-bool IS31FL3741_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
-    // unlock the command register and select PG2
+static void IS31FL3741_select_pwm_page(uint8_t addr, uint8_t block) {
+    // unlock the command register and select PG0 for the first 180 registers, PG1 for the rest
     IS31FL3741_write_register(addr, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5);
-    IS31FL3741_write_register(addr, ISSI_COMMANDREGISTER, ISSI_PAGE_PWM0);
-
-    for (int i = 0; i < 342; i += 18) {
-        if (i == 180) {
-            // unlock the command register and select PG2
-            IS31FL3741_write_register(addr, ISSI_COMMANDREGISTER_WRITELOCK, 0xC5);
-            IS31FL3741_write_register(addr, ISSI_COMMANDREGISTER, ISSI_PAGE_PWM1);
-        }
-
-        g_twi_transfer_buffer[0] = i % 180;
-        memcpy(g_twi_transfer_buffer + 1, pwm_buffer + i, 18);
+    IS31FL3741_write_register(addr, ISSI_COMMANDREGISTER, block < 10 ? ISSI_PAGE_PWM0 : ISSI_PAGE_PWM1);
+}
 
-#if ISSI_PERSISTENCE > 0
-        for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
-            if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 19, ISSI_TIMEOUT) != 0) {
-                return false;
-            }
-        }
-#else
-        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 19, ISSI_TIMEOUT) != 0) {
-            return false;
-        }
-#endif
-    }
+static bool IS31FL3741_write_pwm_block(uint8_t addr, uint8_t *pwm_buffer, uint8_t block) {
+    // assumes the page of this block is already selected
+    // the last block only holds the 9 registers left, as the total number is 351
+    uint16_t offset = block * 18;
+    uint8_t  length = block < 19 ? 18 : 9;
 
-    // transfer the left cause the total number is 351
-    g_twi_transfer_buffer[0] = 162;
-    memcpy(g_twi_transfer_buffer + 1, pwm_buffer + 342, 9);
+    g_twi_transfer_buffer[0] = offset % 180;
+    memcpy(g_twi_transfer_buffer + 1, pwm_buffer + offset, length);
 
 #if ISSI_PERSISTENCE > 0
     for (uint8_t i = 0; i < ISSI_PERSISTENCE; i++) {
-        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 10, ISSI_TIMEOUT) != 0) {
+        if (i2c_transmit(addr << 1, g_twi_transfer_buffer, length + 1, ISSI_TIMEOUT) != 0) {
             return false;
         }
     }
 #else
-    if (i2c_transmit(addr << 1, g_twi_transfer_buffer, 10, ISSI_TIMEOUT) != 0) {
+    if (i2c_transmit(addr << 1, g_twi_transfer_buffer, length + 1, ISSI_TIMEOUT) != 0) {
         return false;
     }
 #endif
@@ -138,6 +123,19 @@ bool IS31FL3741_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
     return true;
 }
 
+bool IS31FL3741_write_pwm_buffer(uint8_t addr, uint8_t *pwm_buffer) {
+    for (uint8_t block = 0; block < 20; block++) {
+        if (block == 0 || block == 10) {
+            IS31FL3741_select_pwm_page(addr, block);
+        }
+        if (!IS31FL3741_write_pwm_block(addr, pwm_buffer, block)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 void IS31FL3741_init(uint8_t addr) {
     // In order to avoid the LEDs being driven with garbage data
     // in the LED driver's PWM registers, shutdown is enabled last.
@@ -161,18 +159,27 @@ void IS31FL3741_init(uint8_t addr) {
 
     // IS31FL3741_update_led_scaling_registers(addr, 0xFF, 0xFF, 0xFF);
 
+    // resend whatever is buffered
+    g_pwm_buffer_dirty = 0xFFFFF;
+
     // Wait 10ms to ensure the device has woken up.
     wait_ms(10);
 }
 
+static inline void IS31FL3741_set_pwm(uint8_t driver, uint16_t reg, uint8_t value) {
+    if (g_pwm_buffer[driver][reg] != value) {
+        g_pwm_buffer[driver][reg] = value;
+        g_pwm_buffer_dirty |= 1UL << (reg / 18);
+    }
+}
+
 void IS31FL3741_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
     if (index >= 0 && index < DRIVER_LED_TOTAL) {
         is31_led led = g_is31_leds[index];
 
-        g_pwm_buffer[led.driver][led.r] = red;
-        g_pwm_buffer[led.driver][led.g] = green;
-        g_pwm_buffer[led.driver][led.b] = blue;
-        g_pwm_buffer_update_required    = true;
+        IS31FL3741_set_pwm(led.driver, led.r, red);
+        IS31FL3741_set_pwm(led.driver, led.g, green);
+        IS31FL3741_set_pwm(led.driver, led.b, blue);
     }
 }
 
@@ -207,19 +214,27 @@ void IS31FL3741_set_led_control_register(uint8_t index, bool red, bool green, bo
 }
 
 void IS31FL3741_update_pwm_buffers(uint8_t addr1, uint8_t addr2) {
-    if (g_pwm_buffer_update_required) {
-        IS31FL3741_write_pwm_buffer(addr1, g_pwm_buffer[0]);
-    }
+    uint8_t page = UINT8_MAX;
 
-    g_pwm_buffer_update_required = false;
+    // only send the blocks that changed, failed ones are retried on the next update
+    for (uint8_t block = 0; block < 20; block++) {
+        if (!(g_pwm_buffer_dirty & (1UL << block))) {
+            continue;
+        }
+        if (page != block / 10) {
+            page = block / 10;
+            IS31FL3741_select_pwm_page(addr1, block);
+        }
+        if (IS31FL3741_write_pwm_block(addr1, g_pwm_buffer[0], block)) {
+            g_pwm_buffer_dirty &= ~(1UL << block);
+        }
+    }
 }
 
 void IS31FL3741_set_pwm_buffer(const is31_led *pled, uint8_t red, uint8_t green, uint8_t blue) {
-    g_pwm_buffer[pled->driver][pled->r] = red;
-    g_pwm_buffer[pled->driver][pled->g] = green;
-    g_pwm_buffer[pled->driver][pled->b] = blue;
-
-    g_pwm_buffer_update_required = true;
+    IS31FL3741_set_pwm(pled->driver, pled->r, red);
+    IS31FL3741_set_pwm(pled->driver, pled->g, green);
+    IS31FL3741_set_pwm(pled->driver, pled->b, blue);
 }
 
 void IS31FL3741_update_led_control_registers(uint8_t addr, uint8_t index) {
@@ -0,0 +1,150 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <vector>
+
+extern "C" {
+#include "is31fl3733.h"
+#include "i2c_master.h"
+}
+
+#define ADDR_1 0x50
+#define ADDR_2 0x51
+
+// PWM registers of the first three LEDs sit in blocks 0, 2 and 1/3/11
+extern "C" const is31_led g_is31_leds[DRIVER_LED_TOTAL] = {
+    {0, 0x00, 0x01, 0x02},
+    {0, 0x20, 0x21, 0x22},
+    {0, 0x10, 0x30, 0xB0},
+    {1, 0x00, 0x01, 0x02},
+};
+
+struct transfer {
+    uint8_t              address;
+    std::vector<uint8_t> data;
+};
+
+static std::vector<transfer> transfers;
+static int                   fail_transfers = 0;
+
+extern "C" {
+void i2c_init(void) {}
+
+i2c_status_t i2c_transmit(uint8_t address, const uint8_t *data, uint16_t length, uint16_t timeout) {
+    if (fail_transfers > 0) {
+        fail_transfers--;
+        return -1;
+    }
+    transfers.push_back({(uint8_t)(address >> 1), std::vector<uint8_t>(data, data + length)});
+    return 0;
+}
+
+void wait_ms(uint32_t ms) {}
+}
+
+class IS31FL3733PwmBlocks : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        IS31FL3733_set_color_all(0, 0, 0);
+        IS31FL3733_init(ADDR_1, 0);
+        IS31FL3733_init(ADDR_2, 0);
+        flush();
+        transfers.clear();
+        fail_transfers = 0;
+    }
+
+    void flush() {
+        IS31FL3733_update_pwm_buffers(ADDR_1, 0);
+        IS31FL3733_update_pwm_buffers(ADDR_2, 1);
+    }
+
+    // Start register of each PWM block sent, in order
+    std::vector<uint8_t> blocks_sent(uint8_t address) {
+        std::vector<uint8_t> blocks;
+        for (auto &t : transfers) {
+            if (t.address == address && t.data.size() == 17) {
+                blocks.push_back(t.data[0]);
+            }
+        }
+        return blocks;
+    }
+};
+
+TEST_F(IS31FL3733PwmBlocks, InitResendsAllBlocks) {
+    IS31FL3733_init(ADDR_1, 0);
+    transfers.clear();
+    flush();
+    EXPECT_EQ(blocks_sent(ADDR_1).size(), 12u);
+    EXPECT_EQ(blocks_sent(ADDR_2).size(), 12u);
+}
+
+TEST_F(IS31FL3733PwmBlocks, UnchangedColorsSendNothing) {
+    IS31FL3733_set_color_all(0, 0, 0);
+    flush();
+    EXPECT_TRUE(transfers.empty());
+
+    IS31FL3733_set_color(1, 10, 20, 30);
+    flush();
+    transfers.clear();
+    IS31FL3733_set_color(1, 10, 20, 30);
+    flush();
+    EXPECT_TRUE(transfers.empty());
+}
+
+TEST_F(IS31FL3733PwmBlocks, OnlyChangedBlocksAreSent) {
+    IS31FL3733_set_color(1, 10, 20, 30);
+    flush();
+    EXPECT_EQ(blocks_sent(ADDR_1), std::vector<uint8_t>({0x20}));
+    EXPECT_TRUE(blocks_sent(ADDR_2).empty());
+    // unlock and page select, then the block itself
+    EXPECT_EQ(transfers.size(), 3u);
+
+    transfers.clear();
+    IS31FL3733_set_color(2, 1, 2, 3);
+    IS31FL3733_set_color(3, 4, 5, 6);
+    flush();
+    EXPECT_EQ(blocks_sent(ADDR_1), std::vector<uint8_t>({0x10, 0x30, 0xB0}));
+    EXPECT_EQ(blocks_sent(ADDR_2), std::vector<uint8_t>({0x00}));
+}
+
+TEST_F(IS31FL3733PwmBlocks, BlocksCarryBufferedValues) {
+    IS31FL3733_set_color(0, 0x11, 0x22, 0x33);
+    flush();
+    ASSERT_EQ(transfers.size(), 3u);
+    auto &data = transfers[2].data;
+    EXPECT_EQ(data[1], 0x11);
+    EXPECT_EQ(data[2], 0x22);
+    EXPECT_EQ(data[3], 0x33);
+    EXPECT_EQ(data[4], 0x00);
+}
+
+TEST_F(IS31FL3733PwmBlocks, FailedBlocksAreRetried) {
+    IS31FL3733_set_color(0, 1, 1, 1);
+    IS31FL3733_set_color(1, 1, 1, 1);
+
+    // unlock, page select and the first block all fail
+    fail_transfers = 3;
+    IS31FL3733_update_pwm_buffers(ADDR_1, 0);
+    EXPECT_TRUE(blocks_sent(ADDR_1).empty());
+
+    IS31FL3733_update_pwm_buffers(ADDR_1, 0);
+    EXPECT_EQ(blocks_sent(ADDR_1), std::vector<uint8_t>({0x00, 0x20}));
+
+    transfers.clear();
+    IS31FL3733_update_pwm_buffers(ADDR_1, 0);
+    EXPECT_TRUE(transfers.empty());
+}
@@ -0,0 +1,12 @@
+issi_pwm_blocks_DEFS := \
+	-DDRIVER_COUNT=2 \
+	-DDRIVER_LED_TOTAL=4
+
+issi_pwm_blocks_INC := \
+	$(DRIVER_PATH)/issi/tests \
+	$(DRIVER_PATH)/issi \
+	$(TMK_PATH)/common
+
+issi_pwm_blocks_SRC := \
+	$(DRIVER_PATH)/issi/tests/is31fl3733_tests.cpp \
+	$(DRIVER_PATH)/issi/is31fl3733.c
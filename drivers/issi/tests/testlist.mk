@@ -0,0 +1 @@
+TEST_LIST += issi_pwm_blocks
@@ -106,6 +106,39 @@ RGB hsv_to_rgb(HSV hsv) {
 
 RGB hsv_to_rgb_nocie(HSV hsv) { return hsv_to_rgb_impl(hsv, false); }
 
+// Channels of each hue region, picked from {v, p, q, t}. Region 6 is the
+// end of the hue circle and 7 is used for greys
+static const uint8_t PROGMEM hsv_region_channels[8][3] = {
+    {0, 3, 1}, {2, 0, 1}, {1, 0, 3}, {1, 2, 0}, {3, 1, 0}, {0, 1, 2}, {0, 3, 1}, {0, 0, 0},
+};
+
+void hsv_to_rgb_batch(const HSV *hsv, RGB *rgb, uint8_t count) {
+    for (; count > 0; count--, hsv++, rgb++) {
+        uint16_t h = hsv->h;
+        uint16_t s = hsv->s;
+#ifdef USE_CIE1931_CURVE
+        uint16_t v = pgm_read_byte(&CIE1931_CURVE[hsv->v]);
+#else
+        uint16_t v = hsv->v;
+#endif
+
+        // h * 6 / 255 without the division
+        uint8_t region    = (h * 1542 + 6) >> 16;
+        uint8_t remainder = (h * 2 - region * 85) * 3;
+
+        uint8_t channels[4];
+        channels[0] = v;
+        channels[1] = (v * (255 - s)) >> 8;
+        channels[2] = (v * (255 - ((s * remainder) >> 8))) >> 8;
+        channels[3] = (v * (255 - ((s * (255 - remainder)) >> 8))) >> 8;
+
+        const uint8_t *pick = hsv_region_channels[s ? region : 7];
+        rgb->r              = channels[pgm_read_byte(&pick[0])];
+        rgb->g              = channels[pgm_read_byte(&pick[1])];
+        rgb->b              = channels[pgm_read_byte(&pick[2])];
+    }
+}
+
 #ifdef RGBW
 #    ifndef MIN
 #        define MIN(a, b) ((a) < (b) ? (a) : (b))
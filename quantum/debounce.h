@@ -9,3 +9,19 @@ void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool
 bool debounce_active(void);
 
 void debounce_init(uint8_t num_rows);
+
+// Only provided by DEBOUNCE_TYPE = asym_adaptive_pk
+typedef struct {
+    uint16_t bounces;   // input changes ignored while debouncing
+    uint16_t chatters;  // presses that came right after a release
+    uint8_t  press_time;
+    uint8_t  release_time;
+} debounce_stats_t;
+
+// Length of the raw HID report built by debounce_raw_hid_report()
+#define DEBOUNCE_RAW_HID_REPORT_SIZE 8
+
+bool debounce_get_stats(uint8_t row, uint8_t col, debounce_stats_t *stats);
+void debounce_print_stats(void);
+/* fills data with the row, column, bounces, chatters, press time and release time, little endian */
+uint8_t debounce_raw_hid_report(uint8_t row, uint8_t col, uint8_t *data, uint8_t length);
@@ -0,0 +1,259 @@
+/*
+Copyright 2021 QMK
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+Adaptive asymmetric per-key algorithm. A press is pushed at once, then the key
+ignores its input for the press time. A release is only pushed once it has
+lasted the release time. Both times are adjusted per key: bounces late in the
+window and chatter lengthen them, and runs of clean presses shorten them.
+*/
+
+#include "matrix.h"
+#include "timer.h"
+#include "quantum.h"
+#include "debounce.h"
+
+#ifndef DEBOUNCE
+#    define DEBOUNCE 5
+#endif
+
+#ifndef DEBOUNCE_PRESS
+#    define DEBOUNCE_PRESS DEBOUNCE
+#endif
+
+#ifndef DEBOUNCE_RELEASE
+#    define DEBOUNCE_RELEASE DEBOUNCE
+#endif
+
+// How many ms the times can go down for clean keys and up for noisy ones
+#ifndef DEBOUNCE_ADAPT_DOWN
+#    define DEBOUNCE_ADAPT_DOWN 3
+#endif
+
+#ifndef DEBOUNCE_ADAPT_UP
+#    define DEBOUNCE_ADAPT_UP 10
+#endif
+
+// Presses in a row without late bounces before a key's times go down by 1 ms
+#ifndef DEBOUNCE_CLEAN_CYCLES
+#    define DEBOUNCE_CLEAN_CYCLES 16
+#endif
+
+// A press this many ms after a release counts as chatter
+#ifndef DEBOUNCE_CHATTER_TIME
+#    define DEBOUNCE_CHATTER_TIME 20
+#endif
+
+#if DEBOUNCE_PRESS + DEBOUNCE_ADAPT_UP > 255 || DEBOUNCE_RELEASE + DEBOUNCE_ADAPT_UP > 255 || DEBOUNCE_ADAPT_UP > 127 || DEBOUNCE_ADAPT_DOWN > 127
+#    error "Debounce times can't be more than 255 ms"
+#endif
+
+#if DEBOUNCE_CLEAN_CYCLES > 63 || DEBOUNCE_CHATTER_TIME > 255
+#    error "DEBOUNCE_CLEAN_CYCLES can't be more than 63, and DEBOUNCE_CHATTER_TIME more than 255"
+#endif
+
+#define ROW_SHIFTER ((matrix_row_t)1)
+
+typedef struct {
+    uint8_t  timer;    // ms left of the press lockout or the release wait
+    uint8_t  chatter;  // ms left in which a press counts as chatter
+    int8_t   adjust;   // added to the press and release times
+    uint8_t  clean : 6;
+    bool     late : 1;  // bounced late in the window since the last release
+    bool     releasing : 1;
+    uint16_t bounces;
+    uint16_t chatters;
+} debounce_key_t;
+
+static debounce_key_t keys[MATRIX_ROWS][MATRIX_COLS];
+static matrix_row_t   last_raw[MATRIX_ROWS];
+static matrix_row_t   timers_running[MATRIX_ROWS];
+static bool           any_timers_running;
+static uint16_t       last_time;
+
+static uint8_t press_time(const debounce_key_t *key) {
+    int16_t time = DEBOUNCE_PRESS + key->adjust;
+    return time < 1 ? 1 : time;
+}
+
+static uint8_t release_time(const debounce_key_t *key) {
+    int16_t time = DEBOUNCE_RELEASE + key->adjust;
+    return time < 1 ? 1 : time;
+}
+
+static uint8_t count_down(uint8_t timer, uint8_t elapsed) { return timer > elapsed ? timer - elapsed : 0; }
+
+static void count_bounce(debounce_key_t *key, uint8_t window) {
+    if (key->bounces < UINT16_MAX) {
+        key->bounces++;
+    }
+    if (key->timer <= window / 2) {
+        key->late = true;
+    }
+}
+
+static void adapt_on_release(debounce_key_t *key) {
+    if (key->late) {
+        if (key->adjust < DEBOUNCE_ADAPT_UP) {
+            key->adjust++;
+        }
+        key->clean = 0;
+    } else if (++key->clean >= DEBOUNCE_CLEAN_CYCLES) {
+        if (key->adjust > -DEBOUNCE_ADAPT_DOWN) {
+            key->adjust--;
+        }
+        key->clean = 0;
+    }
+    key->late = false;
+}
+
+static void adapt_on_chatter(debounce_key_t *key) {
+    if (key->chatters < UINT16_MAX) {
+        key->chatters++;
+    }
+    // A bounce got through the release wait, so lengthen the times faster
+    key->adjust = key->adjust + 2 > DEBOUNCE_ADAPT_UP ? DEBOUNCE_ADAPT_UP : key->adjust + 2;
+    key->clean  = 0;
+}
+
+// we use num_rows rather than MATRIX_ROWS to support split keyboards
+void debounce_init(uint8_t num_rows) {
+    for (uint8_t row = 0; row < num_rows; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            keys[row][col] = (debounce_key_t){0};
+        }
+        last_raw[row]       = 0;
+        timers_running[row] = 0;
+    }
+    any_timers_running = false;
+    last_time          = timer_read();
+}
+
+void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+    uint16_t now     = timer_read();
+    uint16_t elapsed = TIMER_DIFF_16(now, last_time);
+    last_time        = now;
+
+    if (!changed && !any_timers_running) {
+        return;
+    }
+    if (elapsed > 255) {
+        elapsed = 255;
+    }
+
+    any_timers_running = false;
+    for (uint8_t row = 0; row < num_rows; row++) {
+        matrix_row_t moved = raw[row] ^ last_raw[row];
+        matrix_row_t todo  = timers_running[row] | moved | (raw[row] ^ cooked[row]);
+        last_raw[row]      = raw[row];
+
+        for (uint8_t col = 0; todo; col++) {
+            matrix_row_t col_mask = ROW_SHIFTER << col;
+            if (!(todo & col_mask)) {
+                continue;
+            }
+            todo &= ~col_mask;
+
+            debounce_key_t *key     = &keys[row][col];
+            bool            pressed = raw[row] & col_mask;
+            key->chatter            = count_down(key->chatter, elapsed);
+            key->timer              = count_down(key->timer, elapsed);
+
+            if (!(cooked[row] & col_mask)) {
+                if (pressed) {
+                    if (key->chatter) {
+                        adapt_on_chatter(key);
+                    }
+                    cooked[row] |= col_mask;
+                    key->chatter = 0;
+                    key->timer   = press_time(key);
+                }
+            } else if (key->releasing) {
+                if (pressed) {
+                    // Bounced back before the release lasted long enough
+                    count_bounce(key, release_time(key));
+                    key->releasing = false;
+                    key->timer     = 0;
+                } else if (!key->timer) {
+                    cooked[row] &= ~col_mask;
+                    key->releasing = false;
+                    key->chatter   = DEBOUNCE_CHATTER_TIME;
+                    adapt_on_release(key);
+                }
+            } else if (key->timer) {
+                if (moved & col_mask) {
+                    count_bounce(key, press_time(key));
+                }
+            } else if (!pressed) {
+                key->releasing = true;
+                key->timer     = release_time(key);
+            }
+
+            if (key->timer || key->chatter) {
+                timers_running[row] |= col_mask;
+                any_timers_running = true;
+            } else {
+                timers_running[row] &= ~col_mask;
+            }
+        }
+    }
+}
+
+bool debounce_active(void) { return any_timers_running; }
+
+bool debounce_get_stats(uint8_t row, uint8_t col, debounce_stats_t *stats) {
+    if (row >= MATRIX_ROWS || col >= MATRIX_COLS) {
+        return false;
+    }
+    const debounce_key_t *key = &keys[row][col];
+    stats->bounces            = key->bounces;
+    stats->chatters           = key->chatters;
+    stats->press_time         = press_time(key);
+    stats->release_time       = release_time(key);
+    return true;
+}
+
+void debounce_print_stats(void) {
+#ifdef CONSOLE_ENABLE
+    debounce_stats_t stats;
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            debounce_get_stats(row, col, &stats);
+            if (stats.bounces || stats.chatters) {
+                xprintf("key %u,%u: %u bounces, %u chatters, press %u release %u ms\n", row, col, stats.bounces, stats.chatters, stats.press_time, stats.release_time);
+            }
+        }
+    }
+#endif
+}
+
+uint8_t debounce_raw_hid_report(uint8_t row, uint8_t col, uint8_t *data, uint8_t length) {
+    debounce_stats_t stats;
+    if (length < DEBOUNCE_RAW_HID_REPORT_SIZE || !debounce_get_stats(row, col, &stats)) {
+        return 0;
+    }
+
+    data[0] = row;
+    data[1] = col;
+    data[2] = stats.bounces & 0xFF;
+    data[3] = stats.bounces >> 8;
+    data[4] = stats.chatters & 0xFF;
+    data[5] = stats.chatters >> 8;
+    data[6] = stats.press_time;
+    data[7] = stats.release_time;
+    return DEBOUNCE_RAW_HID_REPORT_SIZE;
+}
@@ -0,0 +1,176 @@
+/*
+Copyright 2021 QMK
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+Bit-sliced per-key or per-row algorithm, deferred or eager, with separate
+press and release times. Each key has a counter of the milliseconds it has
+left, and bit n of the counters of a row is kept in counters[n][row], so a
+whole row is counted down with a few operations on matrix_row_t words.
+*/
+
+#include "matrix.h"
+#include "timer.h"
+#include "quantum.h"
+
+#ifndef DEBOUNCE
+#    define DEBOUNCE 5
+#endif
+
+#ifndef DEBOUNCE_PRESS
+#    define DEBOUNCE_PRESS DEBOUNCE
+#endif
+
+#ifndef DEBOUNCE_RELEASE
+#    define DEBOUNCE_RELEASE DEBOUNCE
+#endif
+
+#define MAX_DEBOUNCE (DEBOUNCE_PRESS > DEBOUNCE_RELEASE ? DEBOUNCE_PRESS : DEBOUNCE_RELEASE)
+
+#if MAX_DEBOUNCE > 255
+#    error "DEBOUNCE_PRESS and DEBOUNCE_RELEASE can't be more than 255"
+#elif MAX_DEBOUNCE > 127
+#    define COUNTER_BITS 8
+#elif MAX_DEBOUNCE > 63
+#    define COUNTER_BITS 7
+#elif MAX_DEBOUNCE > 31
+#    define COUNTER_BITS 6
+#elif MAX_DEBOUNCE > 15
+#    define COUNTER_BITS 5
+#elif MAX_DEBOUNCE > 7
+#    define COUNTER_BITS 4
+#elif MAX_DEBOUNCE > 3
+#    define COUNTER_BITS 3
+#elif MAX_DEBOUNCE > 1
+#    define COUNTER_BITS 2
+#else
+#    define COUNTER_BITS 1
+#endif
+
+#define ALL_KEYS ((matrix_row_t)~(matrix_row_t)0)
+
+static matrix_row_t counters[COUNTER_BITS][MATRIX_ROWS];
+static uint16_t     last_time;
+static bool         counters_running;
+
+// The keys sharing a counter with any of the given keys
+static inline matrix_row_t debounce_units(matrix_row_t keys) {
+#ifdef DEBOUNCE_PER_ROW
+    return keys ? ALL_KEYS : 0;
+#else
+    return keys;
+#endif
+}
+
+static inline matrix_row_t counters_running_in(uint8_t row) {
+    matrix_row_t running = 0;
+    for (uint8_t bit = 0; bit < COUNTER_BITS; bit++) {
+        running |= counters[bit][row];
+    }
+    return running;
+}
+
+static inline void counters_load(uint8_t row, matrix_row_t keys, uint8_t value) {
+    for (uint8_t bit = 0; bit < COUNTER_BITS; bit++) {
+        counters[bit][row] = (counters[bit][row] & ~keys) | (((value >> bit) & 1) ? keys : 0);
+    }
+}
+
+// Subtracts elapsed from every counter in the row, stopping at zero
+static inline void counters_subtract(uint8_t row, uint8_t elapsed) {
+    matrix_row_t borrow = 0;
+    for (uint8_t bit = 0; bit < COUNTER_BITS; bit++) {
+        matrix_row_t x     = counters[bit][row];
+        matrix_row_t y     = ((elapsed >> bit) & 1) ? ALL_KEYS : 0;
+        counters[bit][row] = x ^ y ^ borrow;
+        borrow             = (~x & (y | borrow)) | (x & y & borrow);
+    }
+    for (uint8_t bit = 0; bit < COUNTER_BITS; bit++) {
+        counters[bit][row] &= ~borrow;
+    }
+}
+
+// we use num_rows rather than MATRIX_ROWS to support split keyboards
+void debounce_init(uint8_t num_rows) {
+    for (uint8_t row = 0; row < num_rows; row++) {
+        counters_load(row, ALL_KEYS, 0);
+    }
+    counters_running = false;
+    last_time        = timer_read();
+}
+
+void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed) {
+    uint16_t now     = timer_read();
+    uint16_t elapsed = TIMER_DIFF_16(now, last_time);
+    last_time        = now;
+
+    if (!changed && !counters_running) {
+        return;
+    }
+    if (elapsed > MAX_DEBOUNCE) {
+        elapsed = MAX_DEBOUNCE;
+    }
+
+    counters_running = false;
+    for (uint8_t row = 0; row < num_rows; row++) {
+        matrix_row_t running = counters_running_in(row);
+        matrix_row_t delta   = raw[row] ^ cooked[row];
+        if (!running && !delta) {
+            continue;
+        }
+
+        matrix_row_t expired = 0;
+        if (running && elapsed) {
+            counters_subtract(row, elapsed);
+            expired = running;
+            running = counters_running_in(row);
+            expired &= ~running;
+        }
+
+#ifdef DEBOUNCE_EAGER
+        // A change goes through at once, then the key ignores its input for a while
+        matrix_row_t start = debounce_units(delta) & ~running;
+        cooked[row] ^= start & delta;
+#else
+        // A change goes through once it has lasted long enough, and has to
+        // start over if the key bounces back before then
+        cooked[row] ^= expired & delta;
+        delta &= ~expired;
+        matrix_row_t start   = debounce_units(delta) & ~running;
+        matrix_row_t stopped = running & ~debounce_units(delta);
+        if (stopped) {
+            counters_load(row, stopped, 0);
+            running &= ~stopped;
+        }
+#endif
+
+        if (start) {
+            matrix_row_t presses = debounce_units(start & delta & raw[row]) & start;
+            counters_load(row, presses, DEBOUNCE_PRESS);
+            counters_load(row, start & ~presses, DEBOUNCE_RELEASE);
+            running = counters_running_in(row);
+#ifndef DEBOUNCE_EAGER
+            // Changes with no time to wait for
+            cooked[row] ^= start & delta & ~running;
+#endif
+        }
+        if (running) {
+            counters_running = true;
+        }
+    }
+}
+
+bool debounce_active(void) { return counters_running; }
@@ -0,0 +1,23 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define DEBOUNCE_VARIANT bit_sliced_eager_pr
+#define DEBOUNCE_EAGER
+#define DEBOUNCE_PER_ROW
+#include "debounce_rename.h"
+#include "../bit_sliced.c"
+
+DEBOUNCE_VARIANT_DEFINE("bit_sliced_eager_pr");
@@ -0,0 +1,37 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "debounce_variant.h"
+
+// Include before the algorithm, with DEBOUNCE_VARIANT set to its name
+#define VARIANT_NAME_(variant, name) variant##_##name
+#define VARIANT_NAME(variant, name) VARIANT_NAME_(variant, name)
+
+#define debounce VARIANT_NAME(DEBOUNCE_VARIANT, debounce)
+#define debounce_init VARIANT_NAME(DEBOUNCE_VARIANT, debounce_init)
+#define debounce_active VARIANT_NAME(DEBOUNCE_VARIANT, debounce_active)
+#define update_debounce_counters VARIANT_NAME(DEBOUNCE_VARIANT, update_debounce_counters)
+#define transfer_matrix_values VARIANT_NAME(DEBOUNCE_VARIANT, transfer_matrix_values)
+#define start_debounce_counters VARIANT_NAME(DEBOUNCE_VARIANT, start_debounce_counters)
+#define debounce_get_stats VARIANT_NAME(DEBOUNCE_VARIANT, debounce_get_stats)
+#define debounce_print_stats VARIANT_NAME(DEBOUNCE_VARIANT, debounce_print_stats)
+#define debounce_raw_hid_report VARIANT_NAME(DEBOUNCE_VARIANT, debounce_raw_hid_report)
+#define update_debounce_counters_and_transfer_if_expired VARIANT_NAME(DEBOUNCE_VARIANT, update_debounce_counters_and_transfer_if_expired)
+
+// Use after the algorithm to define <DEBOUNCE_VARIANT>_variant
+#define DEBOUNCE_VARIANT_DEFINE(name) const debounce_variant_t VARIANT_NAME(DEBOUNCE_VARIANT, variant) = {name, debounce_init, debounce, debounce_active}
@@ -0,0 +1,207 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <array>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+extern "C" {
+#include "debounce_variant.h"
+#include "timer.h"
+
+void advance_time(uint32_t ms);
+void set_time(uint32_t t);
+}
+
+typedef std::array<matrix_row_t, MATRIX_ROWS> scan_t;
+
+static const debounce_variant_t* const variants[] = {
+    &sym_defer_g_variant, &sym_defer_pk_variant, &sym_eager_pk_variant, &sym_eager_pr_variant, &bit_sliced_defer_pk_variant, &bit_sliced_eager_pk_variant, &bit_sliced_eager_pr_variant, &bit_sliced_asym_variant, &asym_adaptive_pk_variant,
+};
+
+/* One raw scan per millisecond of typing. A key is pressed every 25 ms and
+ * held for 60 ms, and both edges bounce once in the first 2 ms. That leaves
+ * enough quiet time for every algorithm to see every press.
+ */
+static std::vector<scan_t> typing_trace(int presses) {
+    std::vector<scan_t> trace(presses * 25 + 100, scan_t{});
+    std::vector<int>    released_at(MATRIX_ROWS * MATRIX_COLS, -100);
+    uint32_t            seed = 12345;
+
+    for (int i = 0; i < presses; i++) {
+        int start = i * 25;
+        int key;
+        do {
+            seed = seed * 1103515245 + 12345;
+            key  = (seed >> 16) % (MATRIX_ROWS * MATRIX_COLS);
+        } while (released_at[key] + 2 >= start);
+        int end          = start + 60;
+        released_at[key] = end;
+
+        for (int t = start; t <= end + 1; t++) {
+            bool pressed = (t < end && t != start + 1) || t == end + 1;
+            if (pressed) {
+                trace[t][key / MATRIX_COLS] |= (matrix_row_t)1 << (key % MATRIX_COLS);
+            }
+        }
+    }
+    return trace;
+}
+
+// Runs the trace through the algorithm, returning the time taken per scan in ns
+static double run_trace(const debounce_variant_t* variant, const std::vector<scan_t>& trace, std::vector<scan_t>* output = nullptr) {
+    scan_t raw{}, cooked{};
+
+    set_time(0);
+    variant->init(MATRIX_ROWS);
+    if (output) {
+        output->clear();
+        output->reserve(trace.size());
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (const scan_t& scan : trace) {
+        bool changed = scan != raw;
+        raw          = scan;
+        variant->run(raw.data(), cooked.data(), MATRIX_ROWS, changed);
+        if (output) {
+            output->push_back(cooked);
+        }
+        advance_time(1);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / trace.size();
+}
+
+static int count_presses(const std::vector<scan_t>& scans) {
+    int    presses = 0;
+    scan_t last{};
+    for (const scan_t& scan : scans) {
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            presses += __builtin_popcountll(scan[row] & ~last[row]);
+        }
+        last = scan;
+    }
+    return presses;
+}
+
+TEST(Debounce, EveryAlgorithmSeesEachPressOnce) {
+    auto                trace = typing_trace(200);
+    std::vector<scan_t> cooked;
+
+    for (const debounce_variant_t* variant : variants) {
+        run_trace(variant, trace, &cooked);
+        EXPECT_EQ(count_presses(cooked), 200) << variant->name;
+        EXPECT_EQ(cooked.back(), scan_t{}) << variant->name;
+    }
+}
+
+TEST(Debounce, BitSlicedMatchesExistingAlgorithms) {
+    auto                trace = typing_trace(200);
+    std::vector<scan_t> expected, cooked;
+
+    const debounce_variant_t* pairs[][2] = {
+        {&sym_defer_pk_variant, &bit_sliced_defer_pk_variant},
+        {&sym_eager_pk_variant, &bit_sliced_eager_pk_variant},
+        {&sym_eager_pr_variant, &bit_sliced_eager_pr_variant},
+    };
+    for (auto& pair : pairs) {
+        run_trace(pair[0], trace, &expected);
+        run_trace(pair[1], trace, &cooked);
+        EXPECT_EQ(cooked, expected) << pair[1]->name;
+    }
+}
+
+TEST(Debounce, PressAndReleaseTimesAreSeparate) {
+    // Pressed for 20 ms, then released
+    std::vector<scan_t> trace(40, scan_t{}), cooked;
+    for (int t = 0; t < 20; t++) {
+        trace[t][0] = 1;
+    }
+
+    run_trace(&bit_sliced_asym_variant, trace, &cooked);
+    EXPECT_EQ(cooked[1][0], 0);
+    EXPECT_EQ(cooked[2][0], 1);
+    EXPECT_EQ(cooked[29][0], 1);
+    EXPECT_EQ(cooked[30][0], 0);
+}
+
+// Key 0,0 goes down at edges[0], up at edges[1], down at edges[2] and so on
+static std::vector<scan_t> key_trace(std::vector<int> edges, int length) {
+    std::vector<scan_t> trace(length, scan_t{});
+    for (size_t i = 0; i < edges.size(); i += 2) {
+        int end = i + 1 < edges.size() ? edges[i + 1] : length;
+        for (int t = edges[i]; t < end; t++) {
+            trace[t][0] = 1;
+        }
+    }
+    return trace;
+}
+
+TEST(Debounce, AdaptiveTimesGoDownForCleanKeys) {
+    std::vector<int> edges;
+    for (int i = 0; i < 48; i++) {
+        edges.push_back(i * 100);
+        edges.push_back(i * 100 + 40);
+    }
+    std::vector<scan_t> cooked;
+    run_trace(&asym_adaptive_pk_variant, key_trace(edges, 4800), &cooked);
+
+    // 1 ms shorter every 16 presses, the last release was still waited for 3 ms
+    EXPECT_EQ(cooked[4742][0], 1);
+    EXPECT_EQ(cooked[4743][0], 0);
+
+    debounce_stats_t stats;
+    asym_adaptive_pk_debounce_get_stats(0, 0, &stats);
+    EXPECT_EQ(stats.bounces, 0);
+    EXPECT_EQ(stats.chatters, 0);
+    EXPECT_EQ(stats.press_time, 2);
+    EXPECT_EQ(stats.release_time, 2);
+}
+
+TEST(Debounce, AdaptiveTimesGoUpForNoisyKeys) {
+    // The first release bounces 3 ms in, the second one is followed by chatter
+    std::vector<scan_t> cooked;
+    run_trace(&asym_adaptive_pk_variant, key_trace({0, 40, 43, 44, 100, 140, 150, 160}, 300), &cooked);
+
+    debounce_stats_t stats;
+    asym_adaptive_pk_debounce_get_stats(0, 0, &stats);
+    EXPECT_EQ(stats.bounces, 1);
+    EXPECT_EQ(stats.chatters, 1);
+    EXPECT_EQ(stats.press_time, 5 + 1 + 2);
+    EXPECT_EQ(stats.release_time, 5 + 1 + 2);
+
+    // The press comes through at once, and the releases after 5 then 6 ms of quiet
+    EXPECT_EQ(cooked[0][0], 1);
+    EXPECT_EQ(cooked[48][0], 1);
+    EXPECT_EQ(cooked[49][0], 0);
+    EXPECT_EQ(cooked[145][0], 1);
+    EXPECT_EQ(cooked[146][0], 0);
+    EXPECT_EQ(cooked[150][0], 1);
+}
+
+TEST(Debounce, Benchmark) {
+    auto trace = typing_trace(2000);
+
+    for (const debounce_variant_t* variant : variants) {
+        // Warm up first
+        run_trace(variant, trace);
+        double ns = run_trace(variant, trace);
+        std::cout << MATRIX_ROWS << "x" << MATRIX_COLS << " " << variant->name << ": " << ns << " ns per scan" << std::endl;
+    }
+}
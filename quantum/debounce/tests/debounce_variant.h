@@ -0,0 +1,52 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "matrix.h"
+#include "debounce.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* One debounce algorithm, built with its API renamed so that several can be
+ * linked into one test. See debounce_rename.h.
+ */
+typedef struct {
+    const char *name;
+    void (*init)(uint8_t num_rows);
+    void (*run)(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed);
+    bool (*active)(void);
+} debounce_variant_t;
+
+extern const debounce_variant_t sym_defer_g_variant;
+extern const debounce_variant_t sym_defer_pk_variant;
+extern const debounce_variant_t sym_eager_pk_variant;
+extern const debounce_variant_t sym_eager_pr_variant;
+extern const debounce_variant_t bit_sliced_defer_pk_variant;
+extern const debounce_variant_t bit_sliced_eager_pk_variant;
+extern const debounce_variant_t bit_sliced_eager_pr_variant;
+extern const debounce_variant_t bit_sliced_asym_variant;
+extern const debounce_variant_t asym_adaptive_pk_variant;
+
+bool asym_adaptive_pk_debounce_get_stats(uint8_t row, uint8_t col, debounce_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
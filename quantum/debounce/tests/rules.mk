@@ -0,0 +1,25 @@
+debounce_6x22_INC := \
+	$(QUANTUM_PATH)/debounce/tests \
+	$(TMK_PATH)/common
+
+debounce_6x22_SRC := \
+	$(QUANTUM_PATH)/debounce/tests/debounce_tests.cpp \
+	$(QUANTUM_PATH)/debounce/tests/debounce_sym_defer_g.c \
+	$(QUANTUM_PATH)/debounce/tests/debounce_sym_defer_pk.c \
+	$(QUANTUM_PATH)/debounce/tests/debounce_sym_eager_pk.c \
+	$(QUANTUM_PATH)/debounce/tests/debounce_sym_eager_pr.c \
+	$(QUANTUM_PATH)/debounce/tests/debounce_bit_sliced_defer_pk.c \
+	$(QUANTUM_PATH)/debounce/tests/debounce_bit_sliced_eager_pk.c \
+	$(QUANTUM_PATH)/debounce/tests/debounce_bit_sliced_eager_pr.c \
+	$(QUANTUM_PATH)/debounce/tests/debounce_bit_sliced_asym.c \
+	$(QUANTUM_PATH)/debounce/tests/debounce_asym_adaptive_pk.c \
+	$(TMK_PATH)/common/test/timer.c
+
+debounce_6x22_CONFIG := \
+	$(QUANTUM_PATH)/debounce/tests/debounce_6x22_config.h
+
+debounce_16x16_INC := $(debounce_6x22_INC)
+debounce_16x16_SRC := $(debounce_6x22_SRC)
+
+debounce_16x16_CONFIG := \
+	$(QUANTUM_PATH)/debounce/tests/debounce_16x16_config.h
@@ -0,0 +1,2 @@
+TEST_LIST += debounce_6x22
+TEST_LIST += debounce_16x16
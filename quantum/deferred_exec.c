@@ -0,0 +1,246 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include "deferred_exec.h"
+#include "timer.h"
+
+#if MAX_DEFERRED_EXECUTORS > 254
+#    error "MAX_DEFERRED_EXECUTORS can't be more than 254"
+#endif
+
+#define WHEEL_SLOTS (1 << DEFERRED_EXEC_WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SLOTS - 1)
+#define WHEEL_SHIFT(level) (DEFERRED_EXEC_WHEEL_BITS * (level))
+#define WHEEL_TOP (DEFERRED_EXEC_WHEEL_LEVELS - 1)
+
+#if WHEEL_SLOTS * DEFERRED_EXEC_WHEEL_LEVELS > 255 || WHEEL_SHIFT(DEFERRED_EXEC_WHEEL_LEVELS) > 31
+#    error "The deferred executor timer wheel is too large"
+#endif
+
+#define NO_EXECUTOR 0xFF
+#define RUNNING_SLOT 0xFF  // taken off the wheel while its callback runs
+
+typedef struct {
+    deferred_exec_callback callback;  // NULL for a free executor
+    void *                 cb_arg;
+    uint32_t               due;
+    deferred_token         token;
+    uint8_t                slot;
+    uint8_t                next;
+} deferred_executor_t;
+
+static deferred_executor_t executors[MAX_DEFERRED_EXECUTORS];
+static uint8_t             executor_count;
+
+/* Level n slots are WHEEL_SLOTS^n ms wide. Each slot lists the executors due
+ * in it, and the lower levels are refilled from the next slot of the level
+ * above whenever they wrap around.
+ */
+static uint8_t  wheel[DEFERRED_EXEC_WHEEL_LEVELS * WHEEL_SLOTS];
+static uint8_t  wheel_count[DEFERRED_EXEC_WHEEL_LEVELS];
+static uint32_t wheel_time;
+static bool     wheel_ready;
+
+static deferred_token last_token;
+
+static void wheel_insert(uint8_t index) {
+    deferred_executor_t *exec  = &executors[index];
+    int32_t              delta = (int32_t)(exec->due - wheel_time);
+    uint32_t             when  = exec->due;
+    uint8_t              level = 0;
+
+    if (delta < 0) {
+        when = wheel_time;
+    }
+    while (level < WHEEL_TOP && delta >= ((int32_t)1 << WHEEL_SHIFT(level + 1))) {
+        level++;
+    }
+    if (level == WHEEL_TOP && delta >= ((int32_t)1 << WHEEL_SHIFT(DEFERRED_EXEC_WHEEL_LEVELS))) {
+        // Past the end of the wheel, park it in the last slot until it comes round
+        when = wheel_time + ((uint32_t)WHEEL_MASK << WHEEL_SHIFT(WHEEL_TOP));
+    }
+
+    uint8_t slot = level * WHEEL_SLOTS + ((when >> WHEEL_SHIFT(level)) & WHEEL_MASK);
+    exec->slot   = slot;
+    exec->next   = wheel[slot];
+    wheel[slot]  = index;
+    wheel_count[level]++;
+}
+
+static void wheel_remove(uint8_t index) {
+    deferred_executor_t *exec = &executors[index];
+    if (exec->slot == RUNNING_SLOT) {
+        return;
+    }
+
+    uint8_t *next = &wheel[exec->slot];
+    while (*next != index) {
+        next = &executors[*next].next;
+    }
+    *next = exec->next;
+    wheel_count[exec->slot / WHEEL_SLOTS]--;
+}
+
+static void wheel_cascade(uint8_t level) {
+    uint8_t slot  = level * WHEEL_SLOTS + ((wheel_time >> WHEEL_SHIFT(level)) & WHEEL_MASK);
+    uint8_t index = wheel[slot];
+
+    wheel[slot] = NO_EXECUTOR;
+    while (index != NO_EXECUTOR) {
+        uint8_t next = executors[index].next;
+        wheel_count[level]--;
+        wheel_insert(index);
+        index = next;
+    }
+}
+
+static void wheel_run(void) {
+    uint8_t *slot = &wheel[wheel_time & WHEEL_MASK];
+
+    // Callbacks may add executors due now to this slot, so pop one at a time
+    while (*slot != NO_EXECUTOR) {
+        uint8_t              index = *slot;
+        deferred_executor_t *exec  = &executors[index];
+
+        *slot      = exec->next;
+        exec->slot = RUNNING_SLOT;
+        wheel_count[0]--;
+
+        uint32_t delay = exec->callback(exec->due, exec->cb_arg);
+
+        // Skip it if the callback cancelled or extended it
+        if (exec->slot != RUNNING_SLOT || !exec->callback) {
+            continue;
+        }
+        if (!delay) {
+            exec->callback = NULL;
+            executor_count--;
+            continue;
+        }
+        // Don't try to catch up on the calls missed while the wheel was behind
+        uint32_t now = timer_read32();
+        exec->due += delay;
+        if (timer_expired32(now, exec->due)) {
+            exec->due = now + delay;
+        }
+        wheel_insert(index);
+    }
+}
+
+static void wheel_tick(void) {
+    for (uint8_t level = WHEEL_TOP; level > 0; level--) {
+        if (!(wheel_time & (((uint32_t)1 << WHEEL_SHIFT(level)) - 1))) {
+            wheel_cascade(level);
+        }
+    }
+    wheel_run();
+}
+
+static deferred_executor_t *find_executor(deferred_token token) {
+    if (token == INVALID_DEFERRED_TOKEN) {
+        return NULL;
+    }
+    for (uint8_t i = 0; i < MAX_DEFERRED_EXECUTORS; i++) {
+        if (executors[i].callback && executors[i].token == token) {
+            return &executors[i];
+        }
+    }
+    return NULL;
+}
+
+deferred_token defer_exec(uint32_t delay_ms, deferred_exec_callback callback, void *cb_arg) {
+    if (!callback) {
+        return INVALID_DEFERRED_TOKEN;
+    }
+    if (!wheel_ready) {
+        for (uint8_t i = 0; i < sizeof(wheel); i++) {
+            wheel[i] = NO_EXECUTOR;
+        }
+        wheel_ready = true;
+    }
+    if (!executor_count) {
+        // Nothing is waiting on the wheel, so it can jump to now
+        wheel_time = timer_read32();
+    }
+
+    for (uint8_t i = 0; i < MAX_DEFERRED_EXECUTORS; i++) {
+        deferred_executor_t *exec = &executors[i];
+        if (exec->callback) {
+            continue;
+        }
+
+        do {
+            if (++last_token == INVALID_DEFERRED_TOKEN) {
+                last_token++;
+            }
+        } while (find_executor(last_token));
+
+        exec->callback = callback;
+        exec->cb_arg   = cb_arg;
+        exec->token    = last_token;
+        exec->due      = timer_read32() + (delay_ms ? delay_ms : 1);
+        executor_count++;
+        wheel_insert(i);
+        return exec->token;
+    }
+    return INVALID_DEFERRED_TOKEN;
+}
+
+bool extend_deferred_exec(deferred_token token, uint32_t delay_ms) {
+    deferred_executor_t *exec = find_executor(token);
+    if (!exec) {
+        return false;
+    }
+    wheel_remove(exec - executors);
+    exec->due = timer_read32() + (delay_ms ? delay_ms : 1);
+    wheel_insert(exec - executors);
+    return true;
+}
+
+bool cancel_deferred_exec(deferred_token token) {
+    deferred_executor_t *exec = find_executor(token);
+    if (!exec) {
+        return false;
+    }
+    wheel_remove(exec - executors);
+    exec->callback = NULL;
+    executor_count--;
+    return true;
+}
+
+void deferred_exec_task(void) {
+    uint32_t now = timer_read32();
+
+    while (wheel_time != now) {
+        if (!executor_count) {
+            wheel_time = now;
+            break;
+        }
+
+        // Nothing can run before the lowest level holding executors wraps around
+        uint32_t step = 1;
+        for (uint8_t level = 0; level < WHEEL_TOP && !wheel_count[level]; level++) {
+            uint32_t width = (uint32_t)1 << WHEEL_SHIFT(level + 1);
+            step           = width - (wheel_time & (width - 1));
+        }
+        if (step > now - wheel_time) {
+            step = now - wheel_time;
+        }
+        wheel_time += step;
+        wheel_tick();
+    }
+}
@@ -0,0 +1,57 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Including the ones used by WPM, tap dance and auto shift
+#ifndef MAX_DEFERRED_EXECUTORS
+#    define MAX_DEFERRED_EXECUTORS 8
+#endif
+
+// Each wheel level has 2^DEFERRED_EXEC_WHEEL_BITS slots
+#ifndef DEFERRED_EXEC_WHEEL_BITS
+#    define DEFERRED_EXEC_WHEEL_BITS 4
+#endif
+
+#ifndef DEFERRED_EXEC_WHEEL_LEVELS
+#    define DEFERRED_EXEC_WHEEL_LEVELS 3
+#endif
+
+typedef uint8_t deferred_token;
+
+#define INVALID_DEFERRED_TOKEN 0
+
+/* returns the delay until the next call, or 0 to stop */
+typedef uint32_t (*deferred_exec_callback)(uint32_t trigger_time, void *cb_arg);
+
+/* calls callback with cb_arg after delay_ms, returns INVALID_DEFERRED_TOKEN if there is no free executor */
+deferred_token defer_exec(uint32_t delay_ms, deferred_exec_callback callback, void *cb_arg);
+/* moves the call to delay_ms from now */
+bool extend_deferred_exec(deferred_token token, uint32_t delay_ms);
+bool cancel_deferred_exec(deferred_token token);
+
+void deferred_exec_task(void);
+
+#ifdef __cplusplus
+}
+#endif
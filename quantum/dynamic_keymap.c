@@ -14,6 +14,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
 #include "config.h"
 #include "keymap.h"  // to get keymaps[][][]
 #include "tmk_core/common/eeprom.h"
@@ -30,6 +31,16 @@
 #    define DYNAMIC_KEYMAP_MACRO_COUNT 16
 #endif
 
+// Characters of a macro sent with each send_string call
+#ifndef DYNAMIC_KEYMAP_MACRO_CHUNK_SIZE
+#    define DYNAMIC_KEYMAP_MACRO_CHUNK_SIZE 16
+#endif
+
+// A chunk has to fit a whole tap, down or up code
+#if DYNAMIC_KEYMAP_MACRO_CHUNK_SIZE < 3
+#    error DYNAMIC_KEYMAP_MACRO_CHUNK_SIZE must be at least 3
+#endif
+
 // This is the default EEPROM max address to use for dynamic keymaps.
 // The default is the ATmega32u4 EEPROM max address.
 // Explicitly override it if the keyboard uses a microcontroller with
@@ -77,6 +88,39 @@
 #    define DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE (DYNAMIC_KEYMAP_EEPROM_MAX_ADDR - DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + 1)
 #endif
 
+#define DYNAMIC_KEYMAP_EEPROM_SIZE (DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2)
+
+#ifdef DYNAMIC_KEYMAP_RAM_CACHE
+// Number of layers (starting from layer 0) mirrored in RAM.
+// Keycodes of higher layers are still read from and written to EEPROM directly.
+#    ifndef DYNAMIC_KEYMAP_CACHED_LAYER_COUNT
+#        define DYNAMIC_KEYMAP_CACHED_LAYER_COUNT DYNAMIC_KEYMAP_LAYER_COUNT
+#    endif
+#    if DYNAMIC_KEYMAP_CACHED_LAYER_COUNT > DYNAMIC_KEYMAP_LAYER_COUNT
+#        error DYNAMIC_KEYMAP_CACHED_LAYER_COUNT must not be greater than DYNAMIC_KEYMAP_LAYER_COUNT
+#    endif
+
+// Time without further keymap changes before they are written back to EEPROM
+#    ifndef DYNAMIC_KEYMAP_WRITE_BACK_DELAY
+#        define DYNAMIC_KEYMAP_WRITE_BACK_DELAY 500
+#    endif
+
+#    define DYNAMIC_KEYMAP_CACHE_KEYS (DYNAMIC_KEYMAP_CACHED_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS)
+
+// Keycodes are stored in the same layer/row/column order as in EEPROM,
+// dirty bits mark the keys that still have to be written back.
+static uint16_t dynamic_keymap_cache[DYNAMIC_KEYMAP_CACHE_KEYS];
+static uint8_t  dynamic_keymap_cache_dirty[(DYNAMIC_KEYMAP_CACHE_KEYS + 7) / 8];
+static bool     dynamic_keymap_cache_pending = false;
+static uint16_t dynamic_keymap_cache_timer   = 0;
+
+static void dynamic_keymap_cache_mark_dirty(uint16_t index) {
+    dynamic_keymap_cache_dirty[index / 8] |= 1 << (index % 8);
+    dynamic_keymap_cache_pending = true;
+    dynamic_keymap_cache_timer   = timer_read();
+}
+#endif
+
 uint8_t dynamic_keymap_get_layer_count(void) { return DYNAMIC_KEYMAP_LAYER_COUNT; }
 
 void *dynamic_keymap_key_to_eeprom_address(uint8_t layer, uint8_t row, uint8_t column) {
@@ -85,6 +129,11 @@ void *dynamic_keymap_key_to_eeprom_address(uint8_t layer, uint8_t row, uint8_t c
 }
 
 uint16_t dynamic_keymap_get_keycode(uint8_t layer, uint8_t row, uint8_t column) {
+#ifdef DYNAMIC_KEYMAP_RAM_CACHE
+    if (layer < DYNAMIC_KEYMAP_CACHED_LAYER_COUNT && row < MATRIX_ROWS && column < MATRIX_COLS) {
+        return dynamic_keymap_cache[(layer * MATRIX_ROWS + row) * MATRIX_COLS + column];
+    }
+#endif
     void *address = dynamic_keymap_key_to_eeprom_address(layer, row, column);
     // Big endian, so we can read/write EEPROM directly from host if we want
     uint16_t keycode = eeprom_read_byte(address) << 8;
@@ -93,10 +142,24 @@ uint16_t dynamic_keymap_get_keycode(uint8_t layer, uint8_t row, uint8_t column)
 }
 
 void dynamic_keymap_set_keycode(uint8_t layer, uint8_t row, uint8_t column, uint16_t keycode) {
-    void *address = dynamic_keymap_key_to_eeprom_address(layer, row, column);
-    // Big endian, so we can read/write EEPROM directly from host if we want
-    eeprom_update_byte(address, (uint8_t)(keycode >> 8));
-    eeprom_update_byte(address + 1, (uint8_t)(keycode & 0xFF));
+#ifdef DYNAMIC_KEYMAP_RAM_CACHE
+    if (layer < DYNAMIC_KEYMAP_CACHED_LAYER_COUNT && row < MATRIX_ROWS && column < MATRIX_COLS) {
+        uint16_t index = (layer * MATRIX_ROWS + row) * MATRIX_COLS + column;
+        if (dynamic_keymap_cache[index] != keycode) {
+            dynamic_keymap_cache[index] = keycode;
+            dynamic_keymap_cache_mark_dirty(index);
+        }
+    } else
+#endif
+    {
+        void *address = dynamic_keymap_key_to_eeprom_address(layer, row, column);
+        // Big endian, so we can read/write EEPROM directly from host if we want
+        eeprom_update_byte(address, (uint8_t)(keycode >> 8));
+        eeprom_update_byte(address + 1, (uint8_t)(keycode & 0xFF));
+    }
+#if !defined(NO_ACTION_LAYER) && defined(LAYER_LOOKUP_CACHE)
+    layer_lookup_cache_invalidate_key((keypos_t){.row = row, .col = column});
+#endif
 }
 
 void dynamic_keymap_reset(void) {
@@ -110,14 +173,22 @@ void dynamic_keymap_reset(void) {
             }
         }
     }
+    // The caller usually marks the EEPROM as valid next, so don't defer
+    dynamic_keymap_flush();
 }
 
 void dynamic_keymap_get_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
-    uint16_t dynamic_keymap_eeprom_size = DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2;
-    void *   source                     = (void *)(DYNAMIC_KEYMAP_EEPROM_ADDR + offset);
-    uint8_t *target                     = data;
+    void *   source = (void *)(uintptr_t)(DYNAMIC_KEYMAP_EEPROM_ADDR + offset);
+    uint8_t *target = data;
     for (uint16_t i = 0; i < size; i++) {
-        if (offset + i < dynamic_keymap_eeprom_size) {
+#ifdef DYNAMIC_KEYMAP_RAM_CACHE
+        if (offset + i < DYNAMIC_KEYMAP_CACHE_KEYS * 2) {
+            uint16_t keycode = dynamic_keymap_cache[(offset + i) / 2];
+            // Big endian, matching the EEPROM layout
+            *target = ((offset + i) & 1) ? (uint8_t)(keycode & 0xFF) : (uint8_t)(keycode >> 8);
+        } else
+#endif
+        if (offset + i < DYNAMIC_KEYMAP_EEPROM_SIZE) {
             *target = eeprom_read_byte(source);
         } else {
             *target = 0x00;
@@ -128,16 +199,68 @@ void dynamic_keymap_get_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
 }
 
 void dynamic_keymap_set_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
-    uint16_t dynamic_keymap_eeprom_size = DYNAMIC_KEYMAP_LAYER_COUNT * MATRIX_ROWS * MATRIX_COLS * 2;
-    void *   target                     = (void *)(DYNAMIC_KEYMAP_EEPROM_ADDR + offset);
-    uint8_t *source                     = data;
+    void *   target = (void *)(uintptr_t)(DYNAMIC_KEYMAP_EEPROM_ADDR + offset);
+    uint8_t *source = data;
     for (uint16_t i = 0; i < size; i++) {
-        if (offset + i < dynamic_keymap_eeprom_size) {
+#ifdef DYNAMIC_KEYMAP_RAM_CACHE
+        if (offset + i < DYNAMIC_KEYMAP_CACHE_KEYS * 2) {
+            uint16_t index   = (offset + i) / 2;
+            uint16_t keycode = dynamic_keymap_cache[index];
+            keycode          = ((offset + i) & 1) ? ((keycode & 0xFF00) | *source) : ((keycode & 0x00FF) | (*source << 8));
+            if (dynamic_keymap_cache[index] != keycode) {
+                dynamic_keymap_cache[index] = keycode;
+                dynamic_keymap_cache_mark_dirty(index);
+            }
+        } else
+#endif
+        if (offset + i < DYNAMIC_KEYMAP_EEPROM_SIZE) {
             eeprom_update_byte(target, *source);
         }
         source++;
         target++;
     }
+#if !defined(NO_ACTION_LAYER) && defined(LAYER_LOOKUP_CACHE)
+    layer_lookup_cache_invalidate();
+#endif
+}
+
+void dynamic_keymap_init(void) {
+#ifdef DYNAMIC_KEYMAP_RAM_CACHE
+    void *source = (void *)DYNAMIC_KEYMAP_EEPROM_ADDR;
+    for (uint16_t i = 0; i < DYNAMIC_KEYMAP_CACHE_KEYS; i++) {
+        // Big endian, so we can read/write EEPROM directly from host if we want
+        dynamic_keymap_cache[i] = eeprom_read_byte(source) << 8;
+        dynamic_keymap_cache[i] |= eeprom_read_byte(source + 1);
+        source += 2;
+    }
+    memset(dynamic_keymap_cache_dirty, 0, sizeof(dynamic_keymap_cache_dirty));
+    dynamic_keymap_cache_pending = false;
+#endif
+}
+
+void dynamic_keymap_flush(void) {
+#ifdef DYNAMIC_KEYMAP_RAM_CACHE
+    if (!dynamic_keymap_cache_pending) {
+        return;
+    }
+    void *target = (void *)DYNAMIC_KEYMAP_EEPROM_ADDR;
+    for (uint16_t i = 0; i < DYNAMIC_KEYMAP_CACHE_KEYS; i++, target += 2) {
+        if (dynamic_keymap_cache_dirty[i / 8] & (1 << (i % 8))) {
+            eeprom_update_byte(target, (uint8_t)(dynamic_keymap_cache[i] >> 8));
+            eeprom_update_byte(target + 1, (uint8_t)(dynamic_keymap_cache[i] & 0xFF));
+        }
+    }
+    memset(dynamic_keymap_cache_dirty, 0, sizeof(dynamic_keymap_cache_dirty));
+    dynamic_keymap_cache_pending = false;
+#endif
+}
+
+void dynamic_keymap_task(void) {
+#ifdef DYNAMIC_KEYMAP_RAM_CACHE
+    if (dynamic_keymap_cache_pending && timer_elapsed(dynamic_keymap_cache_timer) >= DYNAMIC_KEYMAP_WRITE_BACK_DELAY) {
+        dynamic_keymap_flush();
+    }
+#endif
 }
 
 // This overrides the one in quantum/keymap_common.c
@@ -154,7 +277,7 @@ uint8_t dynamic_keymap_macro_get_count(void) { return DYNAMIC_KEYMAP_MACRO_COUNT
 uint16_t dynamic_keymap_macro_get_buffer_size(void) { return DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE; }
 
 void dynamic_keymap_macro_get_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
-    void *   source = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset);
+    void *   source = (void *)(uintptr_t)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset);
     uint8_t *target = data;
     for (uint16_t i = 0; i < size; i++) {
         if (offset + i < DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE) {
@@ -168,7 +291,7 @@ void dynamic_keymap_macro_get_buffer(uint16_t offset, uint16_t size, uint8_t *da
 }
 
 void dynamic_keymap_macro_set_buffer(uint16_t offset, uint16_t size, uint8_t *data) {
-    void *   target = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset);
+    void *   target = (void *)(uintptr_t)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + offset);
     uint8_t *source = data;
     for (uint16_t i = 0; i < size; i++) {
         if (offset + i < DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE) {
@@ -180,8 +303,8 @@ void dynamic_keymap_macro_set_buffer(uint16_t offset, uint16_t size, uint8_t *da
 }
 
 void dynamic_keymap_macro_reset(void) {
-    void *p   = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR);
-    void *end = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE);
+    void *p   = (void *)(uintptr_t)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR);
+    void *end = (void *)(uintptr_t)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE);
     while (p != end) {
         eeprom_update_byte(p, 0);
         ++p;
@@ -197,15 +320,15 @@ void dynamic_keymap_macro_send(uint8_t id) {
     // If it's not zero, then we are in the middle
     // of buffer writing, possibly an aborted buffer
     // write. So do nothing.
-    void *p = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE - 1);
+    void *p = (void *)(uintptr_t)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE - 1);
     if (eeprom_read_byte(p) != 0) {
         return;
     }
 
     // Skip N null characters
     // p will then point to the Nth macro
-    p         = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR);
-    void *end = (void *)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE);
+    p         = (void *)(uintptr_t)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR);
+    void *end = (void *)(uintptr_t)(DYNAMIC_KEYMAP_MACRO_EEPROM_ADDR + DYNAMIC_KEYMAP_MACRO_EEPROM_SIZE);
     while (id > 0) {
         // If we are past the end of the buffer, then the buffer
         // contents are garbage, i.e. there were not DYNAMIC_KEYMAP_MACRO_COUNT
@@ -219,28 +342,38 @@ void dynamic_keymap_macro_send(uint8_t id) {
         ++p;
     }
 
-    // Send the macro string one or three chars at a time
-    // by making temporary 1 or 3 char strings
-    char data[4] = {0, 0, 0, 0};
+    // Send the macro string in chunks, so that send_string can keep
+    // modifiers held from one character to the next
+    char    data[DYNAMIC_KEYMAP_MACRO_CHUNK_SIZE + 1];
+    uint8_t length = 0;
     // We already checked there was a null at the end of
     // the buffer, so this cannot go past the end
     while (1) {
-        data[0] = eeprom_read_byte(p++);
-        data[1] = 0;
+        char c = eeprom_read_byte(p++);
         // Stop at the null terminator of this macro string
-        if (data[0] == 0) {
+        if (c == 0) {
             break;
         }
+        // Leave room for a whole code
+        if (length > DYNAMIC_KEYMAP_MACRO_CHUNK_SIZE - 3) {
+            data[length] = 0;
+            send_string(data);
+            length = 0;
+        }
         // If the char is magic (tap, down, up),
-        // add the next char (key to use) and send a 3 char string.
-        if (data[0] == SS_TAP_CODE || data[0] == SS_DOWN_CODE || data[0] == SS_UP_CODE) {
-            data[1] = data[0];
-            data[0] = SS_QMK_PREFIX;
-            data[2] = eeprom_read_byte(p++);
-            if (data[2] == 0) {
+        // add the prefix and the next char (key to use).
+        if (c == SS_TAP_CODE || c == SS_DOWN_CODE || c == SS_UP_CODE) {
+            char keycode = eeprom_read_byte(p++);
+            if (keycode == 0) {
                 break;
             }
+            data[length++] = SS_QMK_PREFIX;
+            data[length++] = c;
+            data[length++] = keycode;
+        } else {
+            data[length++] = c;
         }
-        send_string(data);
     }
+    data[length] = 0;
+    send_string(data);
 }
@@ -18,6 +18,14 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+// With DYNAMIC_KEYMAP_RAM_CACHE, keycodes are served from a RAM copy of the keymap
+// that is loaded by dynamic_keymap_init(). Changes are written back to EEPROM by
+// dynamic_keymap_task() once no further change was made for DYNAMIC_KEYMAP_WRITE_BACK_DELAY,
+// or immediately by dynamic_keymap_flush().
+void dynamic_keymap_init(void);
+void dynamic_keymap_task(void);
+void dynamic_keymap_flush(void);
+
 uint8_t  dynamic_keymap_get_layer_count(void);
 void *   dynamic_keymap_key_to_eeprom_address(uint8_t layer, uint8_t row, uint8_t column);
 uint16_t dynamic_keymap_get_keycode(uint8_t layer, uint8_t row, uint8_t column);
@@ -43,6 +43,92 @@ static inline void setPinInputHigh_atomic(pin_t pin) {
     ATOMIC_BLOCK_FORCEON { setPinInputHigh(pin); }
 }
 
+#ifdef MATRIX_PORT_READS
+#    if defined(DIRECT_PINS)
+#        define PORT_INPUTS (MATRIX_ROWS * MATRIX_COLS)
+#    elif (DIODE_DIRECTION == COL2ROW)
+#        define PORT_INPUTS MATRIX_COLS
+#    else
+#        error MATRIX_PORT_READS is only supported with DIRECT_PINS or COL2ROW
+#    endif
+
+// Consecutive port bits that map to consecutive columns, copied with a single shift
+typedef struct {
+    uint8_t     port;  // index into port_pins
+    uint8_t     bit;   // first port bit
+    uint8_t     col;   // first column
+    uint8_t     width;
+    port_data_t mask;
+} port_run_t;
+
+static pin_t       port_pins[PORT_INPUTS];  // any one pin of each port
+static port_data_t port_data[PORT_INPUTS];
+static uint8_t     port_count;
+static port_run_t  port_runs[PORT_INPUTS];
+static uint8_t     port_run_count;
+#    ifdef DIRECT_PINS
+static uint8_t port_row_runs[MATRIX_ROWS + 1];
+#    endif
+
+static void port_runs_add(pin_t pin, uint8_t col, uint8_t first_run) {
+    uint8_t port = 0;
+    while (port < port_count && getPinPort(port_pins[port]) != getPinPort(pin)) {
+        port++;
+    }
+    if (port == port_count) {
+        port_pins[port_count++] = pin;
+    }
+
+    uint8_t bit = getPinBit(pin);
+    if (port_run_count > first_run) {
+        port_run_t *run = &port_runs[port_run_count - 1];
+        if (run->port == port && run->bit + run->width == bit && run->col + run->width == col) {
+            run->width++;
+            run->mask = (run->mask << 1) | 1;
+            return;
+        }
+    }
+    port_runs[port_run_count++] = (port_run_t){.port = port, .bit = bit, .col = col, .width = 1, .mask = 1};
+}
+
+// Groups the input pins by port once, so that scans only walk the table
+static void init_port_runs(void) {
+    port_count     = 0;
+    port_run_count = 0;
+#    ifdef DIRECT_PINS
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        port_row_runs[row] = port_run_count;
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            if (direct_pins[row][col] != NO_PIN) {
+                port_runs_add(direct_pins[row][col], col, port_row_runs[row]);
+            }
+        }
+    }
+    port_row_runs[MATRIX_ROWS] = port_run_count;
+#    else
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+        port_runs_add(col_pins[col], col, 0);
+    }
+#    endif
+}
+
+static void read_ports(void) {
+    // Inputs are active low
+    for (uint8_t i = 0; i < port_count; i++) {
+        port_data[i] = ~readPinPort(port_pins[i]);
+    }
+}
+
+static matrix_row_t gather_port_runs(uint8_t first, uint8_t last) {
+    matrix_row_t row = 0;
+    for (uint8_t i = first; i < last; i++) {
+        const port_run_t *run = &port_runs[i];
+        row |= (matrix_row_t)((port_data[run->port] >> run->bit) & run->mask) << run->col;
+    }
+    return row;
+}
+#endif
+
 // matrix code
 
 #ifdef DIRECT_PINS
@@ -59,6 +145,10 @@ static void init_pins(void) {
 }
 
 static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row) {
+#    ifdef MATRIX_PORT_READS
+    // The ports were all read at the start of the scan
+    matrix_row_t current_row_value = gather_port_runs(port_row_runs[current_row], port_row_runs[current_row + 1]);
+#    else
     // Start with a clear matrix row
     matrix_row_t current_row_value = 0;
 
@@ -68,6 +158,7 @@ static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row)
             current_row_value |= readPin(pin) ? 0 : (MATRIX_ROW_SHIFTER << col_index);
         }
     }
+#    endif
 
     // If the row has changed, store the row and return the changed flag.
     if (current_matrix[current_row] != current_row_value) {
@@ -105,6 +196,10 @@ static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row)
     select_row(current_row);
     matrix_io_delay();
 
+#        ifdef MATRIX_PORT_READS
+    read_ports();
+    current_row_value = gather_port_runs(0, port_run_count);
+#        else
     // For each col...
     for (uint8_t col_index = 0; col_index < MATRIX_COLS; col_index++) {
         // Select the col pin to read (active low)
@@ -113,6 +208,7 @@ static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row)
         // Populate the matrix row with the state of the col pin
         current_row_value |= pin_state ? 0 : (MATRIX_ROW_SHIFTER << col_index);
     }
+#        endif
 
     // Unselect row
     unselect_row(current_row);
@@ -186,9 +282,190 @@ static bool read_rows_on_col(matrix_row_t current_matrix[], uint8_t current_col)
 #    error DIODE_DIRECTION is not defined!
 #endif
 
+#ifdef MATRIX_INTERRUPT_SCAN
+#    ifndef MATRIX_IDLE_TIMEOUT
+#        define MATRIX_IDLE_TIMEOUT 50
+#    endif
+
+// While idle, every output is driven low so that any key press pulls its input low
+#    if defined(DIRECT_PINS)
+#        define MATRIX_INPUTS (MATRIX_ROWS * MATRIX_COLS)
+static pin_t idle_input_pin(uint8_t i) { return direct_pins[i / MATRIX_COLS][i % MATRIX_COLS]; }
+static void  idle_select_all(void) {}
+static void  idle_unselect_all(void) {}
+#    elif (DIODE_DIRECTION == COL2ROW)
+#        define MATRIX_INPUTS MATRIX_COLS
+static pin_t idle_input_pin(uint8_t i) { return col_pins[i]; }
+static void  idle_select_all(void) {
+    for (uint8_t x = 0; x < MATRIX_ROWS; x++) {
+        select_row(x);
+    }
+}
+static void idle_unselect_all(void) { unselect_rows(); }
+#    elif (DIODE_DIRECTION == ROW2COL)
+#        define MATRIX_INPUTS MATRIX_ROWS
+static pin_t idle_input_pin(uint8_t i) { return row_pins[i]; }
+static void  idle_select_all(void) {
+    for (uint8_t x = 0; x < MATRIX_COLS; x++) {
+        select_col(x);
+    }
+}
+static void idle_unselect_all(void) { unselect_cols(); }
+#    endif
+
+#    if defined(__AVR__)
+#        include <avr/sleep.h>
+
+#        if !defined(PCMSK0)
+#            error "MATRIX_INTERRUPT_SCAN needs PCINT0-7"
+#        endif
+
+// Only PCINT0-7 are used, which are the port B pins on the USB AVRs and the ATmega328P
+static bool wake_pin_enable(pin_t pin) {
+    if ((pin & 0xF0) != (B0 & 0xF0)) {
+        return false;
+    }
+    PCMSK0 |= _BV(pin & 0xF);
+    PCIFR = _BV(PCIF0);
+    PCICR |= _BV(PCIE0);
+    return true;
+}
+
+static void wake_pin_disable(pin_t pin) {
+    if ((pin & 0xF0) == (B0 & 0xF0)) {
+        PCMSK0 &= ~_BV(pin & 0xF);
+    }
+    if (!PCMSK0) {
+        PCICR &= ~_BV(PCIE0);
+    }
+}
+
+ISR(PCINT0_vect) { matrix_wake(); }
+
+#    elif defined(PROTOCOL_CHIBIOS)
+#        if !PAL_USE_CALLBACKS
+#            error "MATRIX_INTERRUPT_SCAN requires PAL_USE_CALLBACKS to be TRUE in halconf.h"
+#        endif
+
+static void wake_pin_callback(void *arg) { matrix_wake(); }
+
+// EXTI channels are shared between ports, so only one input per pin number can wake us up
+static uint32_t wake_pads_used;
+
+static bool wake_pin_enable(pin_t pin) {
+    uint32_t pad = (uint32_t)1 << PAL_PAD(pin);
+    if (wake_pads_used & pad) {
+        return false;
+    }
+    wake_pads_used |= pad;
+    palEnableLineEvent(pin, PAL_EVENT_MODE_FALLING_EDGE);
+    palSetLineCallback(pin, wake_pin_callback, NULL);
+    return true;
+}
+
+static void wake_pin_disable(pin_t pin) {
+    palDisableLineEvent(pin);
+    wake_pads_used &= ~((uint32_t)1 << PAL_PAD(pin));
+}
+
+#    else
+// Host builds provide the pin change interrupts
+bool matrix_wake_pin_enable(pin_t pin);
+void matrix_wake_pin_disable(pin_t pin);
+
+#        define wake_pin_enable matrix_wake_pin_enable
+#        define wake_pin_disable matrix_wake_pin_disable
+#    endif
+
+static volatile bool idle_wake_pending = false;
+static bool          idle              = false;
+static bool          idle_supported    = true;
+static uint16_t      idle_last_activity;
+
+void matrix_wake(void) { idle_wake_pending = true; }
+
+bool matrix_is_idle(void) { return idle; }
+
+__attribute__((weak)) void matrix_idle_sleep(void) {
+#    if defined(__AVR__)
+    // Any interrupt wakes us up, including the 1ms timer tick
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_mode();
+#    elif defined(PROTOCOL_CHIBIOS)
+    chThdSleepMilliseconds(1);
+#    endif
+}
+
+static void idle_disable_wake_pins(void) {
+    for (uint8_t i = 0; i < MATRIX_INPUTS; i++) {
+        pin_t pin = idle_input_pin(i);
+        if (pin != NO_PIN) {
+            wake_pin_disable(pin);
+        }
+    }
+}
+
+static void idle_enter(void) {
+    idle_select_all();
+    matrix_io_delay();
+
+    idle_wake_pending = false;
+    for (uint8_t i = 0; i < MATRIX_INPUTS; i++) {
+        pin_t pin = idle_input_pin(i);
+        if (pin != NO_PIN && !wake_pin_enable(pin)) {
+            // A pin that can't wake us up means the matrix has to keep polling
+            idle_supported = false;
+            idle_disable_wake_pins();
+            idle_unselect_all();
+            return;
+        }
+    }
+    idle = true;
+
+    // Catch any press that landed before the interrupts were enabled
+    for (uint8_t i = 0; i < MATRIX_INPUTS; i++) {
+        pin_t pin = idle_input_pin(i);
+        if (pin != NO_PIN && !readPin(pin)) {
+            idle_wake_pending = true;
+        }
+    }
+}
+
+static void idle_exit(void) {
+    idle_disable_wake_pins();
+    idle_unselect_all();
+    matrix_io_delay();
+
+    idle               = false;
+    idle_wake_pending  = false;
+    idle_last_activity = timer_read();
+}
+
+static bool matrix_is_released(void) {
+    for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
+        if (raw_matrix[i] || matrix[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Go idle once every key has been released and debounced for a while
+static void idle_update(bool changed) {
+    if (changed || !matrix_is_released()) {
+        idle_last_activity = timer_read();
+    } else if (idle_supported && timer_elapsed(idle_last_activity) >= MATRIX_IDLE_TIMEOUT) {
+        idle_enter();
+    }
+}
+#endif
+
 void matrix_init(void) {
     // initialize key pins
     init_pins();
+#ifdef MATRIX_PORT_READS
+    init_port_runs();
+#endif
 
     // initialize matrix state: all keys off
     for (uint8_t i = 0; i < MATRIX_ROWS; i++) {
@@ -198,12 +475,33 @@ void matrix_init(void) {
 
     debounce_init(MATRIX_ROWS);
 
+#ifdef MATRIX_INTERRUPT_SCAN
+    idle               = false;
+    idle_supported     = true;
+    idle_last_activity = timer_read();
+#endif
+
     matrix_init_quantum();
 }
 
 uint8_t matrix_scan(void) {
     bool changed = false;
 
+#ifdef MATRIX_INTERRUPT_SCAN
+    if (idle) {
+        if (!idle_wake_pending) {
+            matrix_idle_sleep();
+            matrix_scan_quantum();
+            return 0;
+        }
+        idle_exit();
+    }
+#endif
+
+#if defined(DIRECT_PINS) && defined(MATRIX_PORT_READS)
+    read_ports();
+#endif
+
 #if defined(DIRECT_PINS) || (DIODE_DIRECTION == COL2ROW)
     // Set row, read cols
     for (uint8_t current_row = 0; current_row < MATRIX_ROWS; current_row++) {
@@ -218,6 +516,10 @@ uint8_t matrix_scan(void) {
 
     debounce(raw_matrix, matrix, MATRIX_ROWS, changed);
 
+#ifdef MATRIX_INTERRUPT_SCAN
+    idle_update(changed);
+#endif
+
     matrix_scan_quantum();
     return (uint8_t)changed;
 }
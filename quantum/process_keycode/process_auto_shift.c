@@ -21,9 +21,10 @@
 
 #    include "process_auto_shift.h"
 
-static uint16_t autoshift_time    = 0;
-static uint16_t autoshift_timeout = AUTO_SHIFT_TIMEOUT;
-static uint16_t autoshift_lastkey = KC_NO;
+static uint16_t       autoshift_time    = 0;
+static uint16_t       autoshift_timeout = AUTO_SHIFT_TIMEOUT;
+static uint16_t       autoshift_lastkey = KC_NO;
+static deferred_token autoshift_timer   = INVALID_DEFERRED_TOKEN;
 static struct {
     // Whether autoshift is enabled.
     bool enabled : 1;
@@ -36,6 +37,8 @@ static struct {
     bool holding_shift : 1;
 } autoshift_flags = {true, false, false, false};
 
+static uint32_t autoshift_timed_out(uint32_t trigger_time, void *cb_arg);
+
 /** \brief Record the press of an autoshiftable key
  *
  *  \return Whether the record should be further processed.
@@ -75,6 +78,7 @@ static bool autoshift_press(uint16_t keycode, uint16_t now, keyrecord_t *record)
     autoshift_lastkey           = keycode;
     autoshift_time              = now;
     autoshift_flags.in_progress = true;
+    autoshift_timer             = defer_exec(autoshift_timeout, autoshift_timed_out, NULL);
 
 #    if !defined(NO_ACTION_ONESHOT) && !defined(NO_ACTION_TAPPING)
     clear_oneshot_layer_state(ONESHOT_OTHER_KEY_PRESSED);
@@ -94,6 +98,8 @@ static void autoshift_end(uint16_t keycode, uint16_t now, bool matrix_trigger) {
     if (autoshift_flags.in_progress) {
         // Process the auto-shiftable key.
         autoshift_flags.in_progress = false;
+        cancel_deferred_exec(autoshift_timer);
+        autoshift_timer = INVALID_DEFERRED_TOKEN;
 
         // Time since the initial press was recorded.
         const uint16_t elapsed = TIMER_DIFF_16(now, autoshift_time);
@@ -135,11 +141,10 @@ static void autoshift_end(uint16_t keycode, uint16_t now, bool matrix_trigger) {
 
 /** \brief Simulates auto-shifted key releases when timeout is hit
  *
- *  Can be called from \c matrix_scan_user so that auto-shifted keys are sent
- *  immediately after the timeout has expired, rather than waiting for the key
- *  to be released.
+ *  Runs from a deferred executor once the timeout has expired, so that
+ *  auto-shifted keys are sent without waiting for the key to be released.
  */
-void autoshift_matrix_scan(void) {
+static void autoshift_check_timeout(void) {
     if (autoshift_flags.in_progress) {
         const uint16_t now     = timer_read();
         const uint16_t elapsed = TIMER_DIFF_16(now, autoshift_time);
@@ -149,6 +154,20 @@ void autoshift_matrix_scan(void) {
     }
 }
 
+static uint32_t autoshift_timed_out(uint32_t trigger_time, void *cb_arg) {
+    autoshift_timer = INVALID_DEFERRED_TOKEN;
+    autoshift_check_timeout();
+    return 0;
+}
+
+/** \brief Polls for the timeout when no deferred executor was free for it
+ */
+void autoshift_matrix_scan(void) {
+    if (autoshift_timer == INVALID_DEFERRED_TOKEN) {
+        autoshift_check_timeout();
+    }
+}
+
 void autoshift_toggle(void) {
     autoshift_flags.enabled = !autoshift_flags.enabled;
     del_weak_mods(MOD_BIT(KC_LSFT));
@@ -26,18 +26,38 @@ extern int      COMBO_LEN;
 
 __attribute__((weak)) void process_combo_event(uint16_t combo_index, bool pressed) {}
 
-static uint16_t timer               = 0;
+#ifdef COMBO_TERM_PER_COMBO
+__attribute__((weak)) uint16_t get_combo_term(uint16_t combo_index, combo_t *combo) { return COMBO_TERM; }
+#    define COMBO_TERM_FOR(index, combo) get_combo_term(index, combo)
+#else
+#    define COMBO_TERM_FOR(index, combo) COMBO_TERM
+#endif
+
+#define COMBO_NONE 0xFFFF
+
 static uint16_t current_combo_index = 0;
-static bool     drop_buffer         = false;
-static bool     is_active           = false;
 static bool     b_combo_enable      = true;  // defaults to enabled
 
-static uint8_t buffer_size = 0;
-#ifdef COMBO_ALLOW_ACTION_KEYS
-static keyrecord_t key_buffer[MAX_COMBO_LENGTH];
-#else
-static uint16_t key_buffer[MAX_COMBO_LENGTH];
-#endif
+/* Key presses held back until the combos they may belong to are resolved */
+typedef struct {
+    uint16_t    keycode;
+    keyrecord_t record;
+} combo_buffered_key_t;
+
+static combo_buffered_key_t key_buffer[COMBO_KEY_BUFFER_LENGTH];
+static uint8_t              key_buffer_head = 0;
+static uint8_t              key_buffer_size = 0;
+
+#define KEY_BUFFER_AT(i) key_buffer[(key_buffer_head + (i)) & (COMBO_KEY_BUFFER_LENGTH - 1)]
+
+/* Resolution state, the timer starts with the first buffered key */
+static uint16_t timer          = 0;
+static uint16_t wait_term      = 0;
+static uint16_t prepared_combo = COMBO_NONE;
+static uint8_t  prepared_count = 0;
+/* Set by combo_key_pressed for the key being processed */
+static bool    key_extends_combo = false;
+static uint8_t combos_waiting    = 0;
 
 static inline void send_combo(uint16_t action, bool pressed) {
     if (action) {
@@ -51,81 +71,242 @@ static inline void send_combo(uint16_t action, bool pressed) {
     }
 }
 
-static inline void dump_key_buffer(bool emit) {
-    if (buffer_size == 0) {
-        return;
+#ifdef COMBO_KEY_INDEX
+/* Index from keycode to the combos containing it, built on the first key event.
+ * Entries are sorted by keycode, then by combo index, so a key event only visits
+ * the combos it belongs to, in the same order as the linear scan.
+ */
+typedef struct {
+    uint16_t keycode;
+    uint16_t combo_index;
+    uint8_t  key_index;
+    uint8_t  key_count;
+} combo_key_index_t;
+
+static combo_key_index_t combo_key_index[COMBO_KEY_INDEX_SIZE];
+static uint16_t          combo_key_index_length = 0;
+static bool              combo_key_index_built  = false;
+static bool              combo_key_index_valid  = false;
+
+static inline uint32_t combo_key_index_order(const combo_key_index_t *entry) { return ((uint32_t)entry->keycode << 16) | entry->combo_index; }
+
+static void combo_key_index_build(void) {
+    combo_key_index_built  = true;
+    combo_key_index_valid  = false;
+    combo_key_index_length = 0;
+
+#    ifndef COMBO_VARIABLE_LEN
+    for (uint16_t i = 0; i < COMBO_COUNT; ++i) {
+#    else
+    for (uint16_t i = 0; i < COMBO_LEN; ++i) {
+#    endif
+        const uint16_t *keys  = key_combos[i].keys;
+        uint8_t         count = 0;
+        while (pgm_read_word(&keys[count]) != COMBO_END) {
+            count++;
+        }
+        if (combo_key_index_length + count > COMBO_KEY_INDEX_SIZE) {
+            // Doesn't fit, keep using the linear scan
+            return;
+        }
+        for (uint8_t k = 0; k < count; k++) {
+            combo_key_index[combo_key_index_length++] = (combo_key_index_t){
+                .keycode     = pgm_read_word(&keys[k]),
+                .combo_index = i,
+                .key_index   = k,
+                .key_count   = count,
+            };
+        }
     }
 
-    if (emit) {
-        for (uint8_t i = 0; i < buffer_size; i++) {
-#ifdef COMBO_ALLOW_ACTION_KEYS
-            const action_t action = store_or_get_action(key_buffer[i].event.pressed, key_buffer[i].event.key);
-            process_action(&(key_buffer[i]), action);
-#else
-            register_code16(key_buffer[i]);
-            send_keyboard_report();
-#endif
+    // Shell sort, to avoid quadratic init time with hundreds of combos
+    for (uint16_t gap = combo_key_index_length / 2; gap > 0; gap /= 2) {
+        for (uint16_t i = gap; i < combo_key_index_length; i++) {
+            combo_key_index_t entry = combo_key_index[i];
+            uint16_t          j     = i;
+            for (; j >= gap && combo_key_index_order(&combo_key_index[j - gap]) > combo_key_index_order(&entry); j -= gap) {
+                combo_key_index[j] = combo_key_index[j - gap];
+            }
+            combo_key_index[j] = entry;
         }
     }
+    combo_key_index_valid = true;
+}
 
-    buffer_size = 0;
+/* Returns the position of the first index entry for keycode, or combo_key_index_length */
+static uint16_t combo_key_index_find(uint16_t keycode) {
+    uint16_t low = 0, high = combo_key_index_length;
+    while (low < high) {
+        uint16_t mid = low + (high - low) / 2;
+        if (combo_key_index[mid].keycode < keycode) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
 }
 
-#define ALL_COMBO_KEYS_ARE_DOWN (((1 << count) - 1) == combo->state)
-#define KEY_STATE_DOWN(key)         \
-    do {                            \
-        combo->state |= (1 << key); \
-    } while (0)
-#define KEY_STATE_UP(key)            \
-    do {                             \
-        combo->state &= ~(1 << key); \
-    } while (0)
+void combo_key_index_reset(void) { combo_key_index_built = false; }
+#endif
 
-static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *record) {
-    uint8_t  count = 0;
-    uint16_t index = -1;
-    /* Find index of keycode and number of combo keys */
-    for (const uint16_t *keys = combo->keys;; ++count) {
-        uint16_t key = pgm_read_word(&keys[count]);
-        if (keycode == key) index = count;
-        if (COMBO_END == key) break;
-    }
+#define COMBO_KEY_BIT(key) ((combo_state_t)1 << (key))
+#define ALL_COMBO_KEYS(count) ((combo_state_t)(COMBO_KEY_BIT((count)-1) | (COMBO_KEY_BIT((count)-1) - 1)))
 
-    /* Continue processing if not a combo key */
-    if (-1 == (int8_t)index) return false;
+typedef void (*combo_visitor_t)(combo_t *combo, uint16_t combo_index, uint8_t key_index, uint8_t key_count);
 
-    bool is_combo_active = is_active;
+/* Calls visit for every combo that contains keycode */
+static void visit_combos(uint16_t keycode, combo_visitor_t visit) {
+#ifdef COMBO_KEY_INDEX
+    if (!combo_key_index_built) {
+        combo_key_index_build();
+    }
+    if (combo_key_index_valid) {
+        for (uint16_t i = combo_key_index_find(keycode); i < combo_key_index_length && combo_key_index[i].keycode == keycode; i++) {
+            const combo_key_index_t *entry = &combo_key_index[i];
+            visit(&key_combos[entry->combo_index], entry->combo_index, entry->key_index, entry->key_count);
+        }
+        return;
+    }
+#endif
+#ifndef COMBO_VARIABLE_LEN
+    for (uint16_t i = 0; i < COMBO_COUNT; ++i) {
+#else
+    for (uint16_t i = 0; i < COMBO_LEN; ++i) {
+#endif
+        uint8_t count = 0;
+        uint8_t index = 0xFF;
+        /* Find index of keycode and number of combo keys */
+        for (const uint16_t *keys = key_combos[i].keys;; ++count) {
+            uint16_t key = pgm_read_word(&keys[count]);
+            if (keycode == key) index = count;
+            if (COMBO_END == key) break;
+        }
+        if (index != 0xFF) {
+            visit(&key_combos[i], i, index, count);
+        }
+    }
+}
 
-    if (record->event.pressed) {
-        KEY_STATE_DOWN(index);
+/* A combo stays a candidate while every buffered key is part of it and its term hasn't run out */
+static void combo_key_pressed(combo_t *combo, uint16_t combo_index, uint8_t key_index, uint8_t key_count) {
+    if (__builtin_popcountl(combo->state) != key_buffer_size - 1) {
+        return;
+    }
+    uint16_t term = COMBO_TERM_FOR(combo_index, combo);
+    if (timer_elapsed(timer) > term) {
+        return;
+    }
 
-        if (is_combo_active) {
-            if (ALL_COMBO_KEYS_ARE_DOWN) { /* Combo was pressed */
-                send_combo(combo->keycode, true);
-                drop_buffer = true;
-            }
+    key_extends_combo = true;
+    combo->state |= COMBO_KEY_BIT(key_index);
+    if (combo->state == ALL_COMBO_KEYS(key_count)) {
+        // Prefer the longest combo, then the first one defined
+        if (key_count > prepared_count || (key_count == prepared_count && combo_index < prepared_combo)) {
+            prepared_combo = combo_index;
+            prepared_count = key_count;
         }
     } else {
-        if (ALL_COMBO_KEYS_ARE_DOWN) { /* Combo was released */
-            send_combo(combo->keycode, false);
-        } else {
-            /* continue processing without immediately returning */
-            is_combo_active = false;
+        combos_waiting++;
+        if (term > wait_term) {
+            wait_term = term;
         }
+    }
+}
+
+static void combo_key_reset(combo_t *combo, uint16_t combo_index, uint8_t key_index, uint8_t key_count) { combo->state = 0; }
+
+static bool combo_key_released_found = false;
 
-        KEY_STATE_UP(index);
+static void combo_key_released(combo_t *combo, uint16_t combo_index, uint8_t key_index, uint8_t key_count) {
+    if (!(combo->held & COMBO_KEY_BIT(key_index))) {
+        return;
+    }
+    combo_key_released_found = true;
+    combo->held &= ~COMBO_KEY_BIT(key_index);
+    if (combo->active) {
+        /* The combo is released with its first key */
+        combo->active       = false;
+        current_combo_index = combo_index;
+        send_combo(combo->keycode, false);
     }
+}
 
-    return is_combo_active;
+static bool combo_has_key(combo_t *combo, uint16_t keycode) {
+    for (const uint16_t *keys = combo->keys;; ++keys) {
+        uint16_t key = pgm_read_word(keys);
+        if (keycode == key) return true;
+        if (COMBO_END == key) return false;
+    }
 }
 
-#define NO_COMBO_KEYS_ARE_DOWN (0 == combo->state)
+/* Fires the longest complete combo, if any, and replays the buffered keys that aren't part of it */
+static void resolve_combos(void) {
+    if (key_buffer_size == 0) {
+        return;
+    }
 
-bool process_combo(uint16_t keycode, keyrecord_t *record) {
-    bool is_combo_key          = false;
-    drop_buffer                = false;
-    bool no_combo_keys_pressed = true;
+    for (uint8_t i = 0; i < key_buffer_size; i++) {
+        visit_combos(KEY_BUFFER_AT(i).keycode, combo_key_reset);
+    }
 
+    combo_t *combo = NULL;
+    if (prepared_combo != COMBO_NONE) {
+        combo               = &key_combos[prepared_combo];
+        combo->held         = ALL_COMBO_KEYS(prepared_count);
+        combo->active       = true;
+        current_combo_index = prepared_combo;
+        send_combo(combo->keycode, true);
+    }
+
+    while (key_buffer_size) {
+        combo_buffered_key_t *key = &KEY_BUFFER_AT(0);
+        key_buffer_head           = (key_buffer_head + 1) & (COMBO_KEY_BUFFER_LENGTH - 1);
+        key_buffer_size--;
+        if (combo && combo_has_key(combo, key->keycode)) {
+            continue;
+        }
+#ifdef COMBO_ALLOW_ACTION_KEYS
+        const action_t action = store_or_get_action(key->record.event.pressed, key->record.event.key);
+        process_action(&key->record, action);
+#else
+        register_code16(key->keycode);
+        send_keyboard_report();
+#endif
+    }
+
+    prepared_combo = COMBO_NONE;
+    prepared_count = 0;
+    wait_term      = 0;
+}
+
+/* Adds a key press to the buffer, returns false if it can't be part of any combo with the keys already buffered */
+static bool buffer_combo_key(uint16_t keycode, keyrecord_t *record) {
+    if (key_buffer_size == 0) {
+        timer = timer_read();
+    } else if (key_buffer_size == COMBO_KEY_BUFFER_LENGTH) {
+        resolve_combos();
+        return buffer_combo_key(keycode, record);
+    }
+
+    KEY_BUFFER_AT(key_buffer_size) = (combo_buffered_key_t){.keycode = keycode, .record = *record};
+    key_buffer_size++;
+    key_extends_combo = false;
+    combos_waiting    = 0;
+    visit_combos(keycode, combo_key_pressed);
+
+    if (!key_extends_combo) {
+        key_buffer_size--;
+        return false;
+    }
+    if (combos_waiting == 0) {
+        /* Nothing longer can match, no need to wait for the term */
+        resolve_combos();
+    }
+    return true;
+}
+
+bool process_combo(uint16_t keycode, keyrecord_t *record) {
     if (keycode == CMB_ON && record->event.pressed) {
         combo_enable();
         return true;
@@ -144,62 +325,45 @@ bool process_combo(uint16_t keycode, keyrecord_t *record) {
     if (!is_combo_enabled()) {
         return true;
     }
-#ifndef COMBO_VARIABLE_LEN
-    for (current_combo_index = 0; current_combo_index < COMBO_COUNT; ++current_combo_index) {
-#else
-    for (current_combo_index = 0; current_combo_index < COMBO_LEN; ++current_combo_index) {
-#endif
-        combo_t *combo = &key_combos[current_combo_index];
-        is_combo_key |= process_single_combo(combo, keycode, record);
-        no_combo_keys_pressed = no_combo_keys_pressed && NO_COMBO_KEYS_ARE_DOWN;
-    }
 
-    if (drop_buffer) {
-        /* buffer is only dropped when we complete a combo, so we refresh the timer
-         * here */
-        timer = timer_read();
-        dump_key_buffer(false);
-    } else if (!is_combo_key) {
-        /* if no combos claim the key we need to emit the keybuffer */
-        dump_key_buffer(true);
-
-        // reset state if there are no combo keys pressed at all
-        if (no_combo_keys_pressed) {
-            timer     = 0;
-            is_active = true;
+    if (record->event.pressed) {
+        if (buffer_combo_key(keycode, record)) {
+            return false;
         }
-    } else if (record->event.pressed && is_active) {
-        /* otherwise the key is consumed and placed in the buffer */
-        timer = timer_read();
-
-        if (buffer_size < MAX_COMBO_LENGTH) {
-#ifdef COMBO_ALLOW_ACTION_KEYS
-            key_buffer[buffer_size++] = *record;
-#else
-            key_buffer[buffer_size++] = keycode;
-#endif
+        if (key_buffer_size) {
+            /* The key ends the combos in progress, it may start new ones */
+            resolve_combos();
+            if (buffer_combo_key(keycode, record)) {
+                return false;
+            }
         }
+        return true;
     }
 
-    return !is_combo_key;
+    for (uint8_t i = 0; i < key_buffer_size; i++) {
+        if (KEY_BUFFER_AT(i).keycode == keycode) {
+            resolve_combos();
+            break;
+        }
+    }
+    combo_key_released_found = false;
+    visit_combos(keycode, combo_key_released);
+    return !combo_key_released_found;
 }
 
 void matrix_scan_combo(void) {
-    if (b_combo_enable && is_active && timer && timer_elapsed(timer) > COMBO_TERM) {
-        /* This disables the combo, meaning key events for this
-         * combo will be handled by the next processors in the chain
-         */
-        is_active = false;
-        dump_key_buffer(true);
+    if (key_buffer_size && timer_elapsed(timer) > wait_term) {
+        resolve_combos();
     }
 }
 
 void combo_enable(void) { b_combo_enable = true; }
 
 void combo_disable(void) {
-    b_combo_enable = is_active = false;
-    timer                      = 0;
-    dump_key_buffer(true);
+    b_combo_enable = false;
+    prepared_combo = COMBO_NONE;
+    prepared_count = 0;
+    resolve_combos();
 }
 
 void combo_toggle(void) {
@@ -28,16 +28,20 @@
 #    define MAX_COMBO_LENGTH 8
 #endif
 
-typedef struct {
-    const uint16_t *keys;
-    uint16_t        keycode;
 #ifdef EXTRA_EXTRA_LONG_COMBOS
-    uint32_t state;
+typedef uint32_t combo_state_t;
 #elif EXTRA_LONG_COMBOS
-    uint16_t state;
+typedef uint16_t combo_state_t;
 #else
-    uint8_t state;
+typedef uint8_t combo_state_t;
 #endif
+
+typedef struct {
+    const uint16_t *keys;
+    uint16_t        keycode;
+    combo_state_t   state;  // keys pressed while the combo is being resolved
+    combo_state_t   held;   // keys of the fired combo that are still down
+    bool            active;
 } combo_t;
 
 #define COMBO(ck, ca) \
@@ -53,11 +57,38 @@ typedef struct {
 #    define COMBO_TERM TAPPING_TERM
 #endif
 
+/* Number of key presses that can be held back while combos are resolved, must be a power of two */
+#ifndef COMBO_KEY_BUFFER_LENGTH
+#    define COMBO_KEY_BUFFER_LENGTH MAX_COMBO_LENGTH
+#endif
+#if (COMBO_KEY_BUFFER_LENGTH & (COMBO_KEY_BUFFER_LENGTH - 1)) != 0
+#    error "COMBO_KEY_BUFFER_LENGTH must be a power of two"
+#endif
+
+#ifdef COMBO_KEY_INDEX
+/* Total number of keys over all combos the index can hold, combos fall back to a linear scan if exceeded */
+#    ifndef COMBO_KEY_INDEX_SIZE
+#        ifndef COMBO_VARIABLE_LEN
+#            define COMBO_KEY_INDEX_SIZE (COMBO_COUNT * 4)
+#        else
+#            define COMBO_KEY_INDEX_SIZE 256
+#        endif
+#    endif
+#endif
+
 bool process_combo(uint16_t keycode, keyrecord_t *record);
 void matrix_scan_combo(void);
 void process_combo_event(uint16_t combo_index, bool pressed);
+#ifdef COMBO_TERM_PER_COMBO
+uint16_t get_combo_term(uint16_t combo_index, combo_t *combo);
+#endif
 
 void combo_enable(void);
 void combo_disable(void);
 void combo_toggle(void);
 bool is_combo_enabled(void);
+
+#ifdef COMBO_KEY_INDEX
+/* Rebuild the index on the next key event, after key_combos was changed at runtime */
+void combo_key_index_reset(void);
+#endif
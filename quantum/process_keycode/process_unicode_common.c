@@ -23,6 +23,11 @@ unicode_config_t unicode_config;
 uint8_t          unicode_saved_mods;
 bool             unicode_saved_caps_lock;
 
+// Set while send_unicode_string() has caps lock and the mods dealt with
+static bool unicode_in_string;
+// Set while UNICODE_KEY_MAC is held from one code point of a string to the next
+static bool unicode_lead_held;
+
 #if UNICODE_SELECTED_MODES != -1
 static uint8_t selected[]     = {UNICODE_SELECTED_MODES};
 static int8_t  selected_count = sizeof selected / sizeof *selected;
@@ -77,7 +82,8 @@ void cycle_unicode_input_mode(int8_t offset) {
 
 void persist_unicode_input_mode(void) { eeprom_update_byte(EECONFIG_UNICODEMODE, unicode_config.input_mode); }
 
-__attribute__((weak)) void unicode_input_start(void) {
+// Caps lock and the mods only have to be dealt with once for a whole string
+static void unicode_session_begin(void) {
     unicode_saved_caps_lock = host_keyboard_led_state().caps_lock;
 
     // Note the order matters here!
@@ -90,7 +96,18 @@ __attribute__((weak)) void unicode_input_start(void) {
 
     unicode_saved_mods = get_mods();  // Save current mods
     clear_mods();                     // Unregister mods to start from a clean state
+}
+
+static void unicode_session_end(void) {
+    if (unicode_config.input_mode == UC_LNX && unicode_saved_caps_lock) {
+        tap_code(KC_CAPS);
+    }
+
+    set_mods(unicode_saved_mods);  // Reregister previously set mods
+}
 
+// The keys starting and ending the input of each code point
+static void unicode_lead(void) {
     switch (unicode_config.input_mode) {
         case UC_MAC:
             register_code(UNICODE_KEY_MAC);
@@ -111,16 +128,13 @@ __attribute__((weak)) void unicode_input_start(void) {
     wait_ms(UNICODE_TYPE_DELAY);
 }
 
-__attribute__((weak)) void unicode_input_finish(void) {
+static void unicode_commit(void) {
     switch (unicode_config.input_mode) {
         case UC_MAC:
             unregister_code(UNICODE_KEY_MAC);
             break;
         case UC_LNX:
             tap_code(KC_SPC);
-            if (unicode_saved_caps_lock) {
-                tap_code(KC_CAPS);
-            }
             break;
         case UC_WIN:
             unregister_code(KC_LALT);
@@ -129,8 +143,34 @@ __attribute__((weak)) void unicode_input_finish(void) {
             tap_code(KC_ENTER);
             break;
     }
+}
 
-    set_mods(unicode_saved_mods);  // Reregister previously set mods
+/* Inside send_unicode_string() these are called for each code point, with
+ * caps lock and the mods already dealt with for the whole string.
+ */
+__attribute__((weak)) void unicode_input_start(void) {
+    if (!unicode_in_string) {
+        unicode_session_begin();
+    }
+    if (!unicode_lead_held) {
+        unicode_lead();
+    }
+}
+
+__attribute__((weak)) void unicode_input_finish(void) {
+    if (unicode_in_string) {
+        // The input method on macOS turns every four digits typed into a
+        // character while UNICODE_KEY_MAC is held, so it stays held
+        if (unicode_config.input_mode == UC_MAC) {
+            unicode_lead_held = true;
+        } else {
+            unicode_commit();
+        }
+        return;
+    }
+
+    unicode_commit();
+    unicode_session_end();
 }
 
 __attribute__((weak)) void unicode_input_cancel(void) {
@@ -140,9 +180,6 @@ __attribute__((weak)) void unicode_input_cancel(void) {
             break;
         case UC_LNX:
             tap_code(KC_ESC);
-            if (unicode_saved_caps_lock) {
-                tap_code(KC_CAPS);
-            }
             break;
         case UC_WINC:
             tap_code(KC_ESC);
@@ -152,7 +189,7 @@ __attribute__((weak)) void unicode_input_cancel(void) {
             break;
     }
 
-    set_mods(unicode_saved_mods);  // Reregister previously set mods
+    unicode_session_end();
 }
 
 void register_hex(uint16_t hex) {
@@ -259,18 +296,64 @@ static const char *decode_utf8(const char *str, int32_t *code_point) {
     return next;
 }
 
+static bool unicode_can_send(int32_t code_point) { return code_point >= 0 && code_point <= 0x10FFFF && (code_point <= 0xFFFF || unicode_config.input_mode != UC_WIN); }
+
+static void unicode_send_hex(uint32_t hex, const uint16_t *hex_keycodes) {
+    // At least four digits, as register_hex32() sends
+    int8_t i = 7;
+    while (i > 3 && !((hex >> (i * 4)) & 0xF)) {
+        i--;
+    }
+    for (; i >= 0; i--) {
+        tap_code16(hex_keycodes[(hex >> (i * 4)) & 0xF]);
+    }
+}
+
+/* Types the whole string in one session, so caps lock and the mods are only
+ * dealt with at the start and the end. Each code point still goes through
+ * unicode_input_start() and unicode_input_finish(), so overrides of them apply.
+ */
 void send_unicode_string(const char *str) {
     if (!str) {
         return;
     }
 
+    uint16_t hex_keycodes[16];
+
     while (*str) {
         int32_t code_point = 0;
         str                = decode_utf8(str, &code_point);
 
-        if (code_point >= 0) {
-            register_unicode(code_point);
+        if (!unicode_can_send(code_point)) {
+            continue;
+        }
+        if (!unicode_in_string) {
+            for (uint8_t i = 0; i < 16; i++) {
+                hex_keycodes[i] = hex_to_keycode(i);
+            }
+            unicode_session_begin();
+            unicode_in_string = true;
         }
+
+        unicode_input_start();
+        if (code_point > 0xFFFF && unicode_config.input_mode == UC_MAC) {
+            // Convert code point to UTF-16 surrogate pair on macOS
+            code_point -= 0x10000;
+            unicode_send_hex((code_point >> 10) + 0xD800, hex_keycodes);
+            unicode_send_hex((code_point & 0x3FF) + 0xDC00, hex_keycodes);
+        } else {
+            unicode_send_hex(code_point, hex_keycodes);
+        }
+        unicode_input_finish();
+    }
+
+    if (unicode_lead_held) {
+        unicode_commit();
+        unicode_lead_held = false;
+    }
+    if (unicode_in_string) {
+        unicode_in_string = false;
+        unicode_session_end();
     }
 }
 
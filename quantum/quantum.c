@@ -16,6 +16,7 @@
 
 #include <ctype.h>
 #include "quantum.h"
+#include "profiler.h"
 
 #ifdef BLUETOOTH_ENABLE
 #    include "outputselect.h"
@@ -143,6 +144,9 @@ void reset_keyboard(void) {
 #endif
 #ifdef HAPTIC_ENABLE
     haptic_shutdown();
+#endif
+#ifdef DYNAMIC_KEYMAP_ENABLE
+    dynamic_keymap_flush();
 #endif
     bootloader_jump();
 }
@@ -434,82 +438,79 @@ __attribute__((weak)) const uint8_t ascii_to_keycode_lut[128] PROGMEM = {
 // Note: we bit-pack in "reverse" order to optimize loading
 #define PGM_LOADBIT(mem, pos) ((pgm_read_byte(&((mem)[(pos) / 8])) >> ((pos) % 8)) & 0x01)
 
-void send_string(const char *str) { send_string_with_delay(str, 0); }
+// Modifiers the last character needed, still held in case the next one needs them too
+static uint8_t send_string_mods = 0;
 
-void send_string_P(const char *str) { send_string_with_delay_P(str, 0); }
+static void send_string_set_mods(uint8_t mods) {
+    if (mods == send_string_mods) {
+        return;
+    }
+    del_mods(send_string_mods & ~mods);
+    add_mods(mods & ~send_string_mods);
+    send_string_mods = mods;
+    send_keyboard_report();
+}
 
-void send_string_with_delay(const char *str, uint8_t interval) {
-    while (1) {
-        char ascii_code = *str;
-        if (!ascii_code) break;
-        if (ascii_code == SS_QMK_PREFIX) {
-            ascii_code = *(++str);
-            if (ascii_code == SS_TAP_CODE) {
-                // tap
-                uint8_t keycode = *(++str);
-                tap_code(keycode);
-            } else if (ascii_code == SS_DOWN_CODE) {
-                // down
-                uint8_t keycode = *(++str);
-                register_code(keycode);
-            } else if (ascii_code == SS_UP_CODE) {
-                // up
-                uint8_t keycode = *(++str);
-                unregister_code(keycode);
-            } else if (ascii_code == SS_DELAY_CODE) {
-                // delay
-                int     ms      = 0;
-                uint8_t keycode = *(++str);
-                while (isdigit(keycode)) {
-                    ms *= 10;
-                    ms += keycode - '0';
-                    keycode = *(++str);
-                }
-                while (ms--) wait_ms(1);
-            }
-        } else {
-            send_char(ascii_code);
-        }
-        ++str;
-        // interval
-        {
-            uint8_t ms = interval;
-            while (ms--) wait_ms(1);
-        }
+static void send_string_char(char ascii_code) {
+#if defined(AUDIO_ENABLE) && defined(SENDSTRING_BELL)
+    if (ascii_code == '\a') {  // BEL
+        PLAY_SONG(bell_song);
+        return;
     }
+#endif
+
+    uint8_t keycode = pgm_read_byte(&ascii_to_keycode_lut[(uint8_t)ascii_code]);
+    uint8_t mods    = 0;
+    if (PGM_LOADBIT(ascii_to_shift_lut, (uint8_t)ascii_code)) {
+        mods |= MOD_BIT(KC_LSFT);
+    }
+    if (PGM_LOADBIT(ascii_to_altgr_lut, (uint8_t)ascii_code)) {
+        mods |= MOD_BIT(KC_RALT);
+    }
+
+    send_string_set_mods(mods);
+    tap_code(keycode);
 }
 
-void send_string_with_delay_P(const char *str, uint8_t interval) {
+typedef char (*send_string_read_t)(const char *str);
+
+static char send_string_read(const char *str) { return *str; }
+
+static char send_string_read_P(const char *str) { return pgm_read_byte(str); }
+
+static void send_string_with_reader(const char *str, uint8_t interval, send_string_read_t read) {
     while (1) {
-        char ascii_code = pgm_read_byte(str);
+        char ascii_code = read(str);
         if (!ascii_code) break;
         if (ascii_code == SS_QMK_PREFIX) {
-            ascii_code = pgm_read_byte(++str);
+            // The codes don't get the modifiers held for the characters
+            send_string_set_mods(0);
+            ascii_code = read(++str);
             if (ascii_code == SS_TAP_CODE) {
                 // tap
-                uint8_t keycode = pgm_read_byte(++str);
+                uint8_t keycode = read(++str);
                 tap_code(keycode);
             } else if (ascii_code == SS_DOWN_CODE) {
                 // down
-                uint8_t keycode = pgm_read_byte(++str);
+                uint8_t keycode = read(++str);
                 register_code(keycode);
             } else if (ascii_code == SS_UP_CODE) {
                 // up
-                uint8_t keycode = pgm_read_byte(++str);
+                uint8_t keycode = read(++str);
                 unregister_code(keycode);
             } else if (ascii_code == SS_DELAY_CODE) {
                 // delay
                 int     ms      = 0;
-                uint8_t keycode = pgm_read_byte(++str);
+                uint8_t keycode = read(++str);
                 while (isdigit(keycode)) {
                     ms *= 10;
                     ms += keycode - '0';
-                    keycode = pgm_read_byte(++str);
+                    keycode = read(++str);
                 }
                 while (ms--) wait_ms(1);
             }
         } else {
-            send_char(ascii_code);
+            send_string_char(ascii_code);
         }
         ++str;
         // interval
@@ -518,33 +519,20 @@ void send_string_with_delay_P(const char *str, uint8_t interval) {
             while (ms--) wait_ms(1);
         }
     }
+    send_string_set_mods(0);
 }
 
-void send_char(char ascii_code) {
-#if defined(AUDIO_ENABLE) && defined(SENDSTRING_BELL)
-    if (ascii_code == '\a') {  // BEL
-        PLAY_SONG(bell_song);
-        return;
-    }
-#endif
+void send_string(const char *str) { send_string_with_delay(str, 0); }
 
-    uint8_t keycode    = pgm_read_byte(&ascii_to_keycode_lut[(uint8_t)ascii_code]);
-    bool    is_shifted = PGM_LOADBIT(ascii_to_shift_lut, (uint8_t)ascii_code);
-    bool    is_altgred = PGM_LOADBIT(ascii_to_altgr_lut, (uint8_t)ascii_code);
+void send_string_P(const char *str) { send_string_with_delay_P(str, 0); }
 
-    if (is_shifted) {
-        register_code(KC_LSFT);
-    }
-    if (is_altgred) {
-        register_code(KC_RALT);
-    }
-    tap_code(keycode);
-    if (is_altgred) {
-        unregister_code(KC_RALT);
-    }
-    if (is_shifted) {
-        unregister_code(KC_LSFT);
-    }
+void send_string_with_delay(const char *str, uint8_t interval) { send_string_with_reader(str, interval, send_string_read); }
+
+void send_string_with_delay_P(const char *str, uint8_t interval) { send_string_with_reader(str, interval, send_string_read_P); }
+
+void send_char(char ascii_code) {
+    send_string_char(ascii_code);
+    send_string_set_mods(0);
 }
 
 void set_single_persistent_default_layer(uint8_t default_layer) {
@@ -634,6 +622,9 @@ void matrix_init_quantum() {
 #if defined(BLUETOOTH_ENABLE) && defined(OUTPUT_AUTO_ENABLE)
     set_output(OUTPUT_AUTO);
 #endif
+#ifdef DYNAMIC_KEYMAP_ENABLE
+    dynamic_keymap_init();
+#endif
 
     matrix_init_kb();
 }
@@ -660,11 +651,9 @@ void matrix_scan_quantum() {
 #endif
 
 #ifdef RGB_MATRIX_ENABLE
+    PROFILE_START(rgb_matrix);
     rgb_matrix_task();
-#endif
-
-#ifdef WPM_ENABLE
-    decay_wpm();
+    PROFILE_END(rgb_matrix, PROFILER_RGB_MATRIX_TASK);
 #endif
 
 #ifdef HAPTIC_ENABLE
@@ -675,6 +664,10 @@ void matrix_scan_quantum() {
     dip_switch_read(false);
 #endif
 
+#ifdef DYNAMIC_KEYMAP_ENABLE
+    dynamic_keymap_task();
+#endif
+
 #ifdef AUTO_SHIFT_ENABLE
     autoshift_matrix_scan();
 #endif
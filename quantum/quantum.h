@@ -192,6 +192,10 @@ extern layer_state_t layer_state;
 #    include "wpm.h"
 #endif
 
+#ifdef DEFERRED_EXEC_ENABLE
+#    include "deferred_exec.h"
+#endif
+
 // Function substitutions to ease GPIO manipulation
 #if defined(__AVR__)
 typedef uint8_t pin_t;
@@ -209,6 +213,12 @@ typedef uint8_t pin_t;
 
 #    define togglePin(pin) (PORTx_ADDRESS(pin) ^= _BV((pin)&0xF))
 
+typedef uint8_t port_data_t;
+
+#    define getPinPort(pin) ((pin) >> PORT_SHIFTER)
+#    define getPinBit(pin) ((pin)&0xF)
+#    define readPinPort(pin) ((port_data_t)PINx_ADDRESS(pin))
+
 #elif defined(PROTOCOL_CHIBIOS)
 typedef ioline_t pin_t;
 
@@ -224,6 +234,32 @@ typedef ioline_t pin_t;
 #    define readPin(pin) palReadLine(pin)
 
 #    define togglePin(pin) palToggleLine(pin)
+
+typedef ioportmask_t port_data_t;
+
+#    define getPinPort(pin) PAL_PORT(pin)
+#    define getPinBit(pin) PAL_PAD(pin)
+#    define readPinPort(pin) palReadPort(PAL_PORT(pin))
+
+#elif !defined(PROTOCOL_ARM_ATSAM)
+// Host builds, such as the unit tests, provide these as functions
+typedef uint8_t pin_t;
+
+void setPinInput(pin_t pin);
+void setPinInputHigh(pin_t pin);
+void setPinOutput(pin_t pin);
+
+void writePinHigh(pin_t pin);
+void writePinLow(pin_t pin);
+#    define writePin(pin, level) ((level) ? writePinHigh(pin) : writePinLow(pin))
+
+bool readPin(pin_t pin);
+
+typedef uint16_t port_data_t;
+
+#    define getPinPort(pin) ((pin) >> 4)
+#    define getPinBit(pin) ((pin)&0xF)
+port_data_t readPinPort(pin_t pin);
 #endif
 
 // Atomic macro to help make GPIO and other controls atomic.
@@ -33,9 +33,104 @@ const point_t k_rgb_matrix_center = RGB_MATRIX_CENTER;
 
 __attribute__((weak)) RGB rgb_matrix_hsv_to_rgb(HSV hsv) { return hsv_to_rgb(hsv); }
 
+__attribute__((weak)) void rgb_matrix_hsv_to_rgb_batch(const HSV *hsv, RGB *rgb, uint8_t count) {
+#ifdef RGB_MATRIX_BATCH_HSV_TO_RGB
+    hsv_to_rgb_batch(hsv, rgb, count);
+#else
+    // Keeps keyboards that override rgb_matrix_hsv_to_rgb() working
+    for (uint8_t i = 0; i < count; i++) {
+        rgb[i] = rgb_matrix_hsv_to_rgb(hsv[i]);
+    }
+#endif
+}
+
+// Effect runners collect a line of colors and convert them together
+typedef struct {
+    uint8_t count;
+    uint8_t index[RGB_MATRIX_BATCH_SIZE];
+    HSV     hsv[RGB_MATRIX_BATCH_SIZE];
+} rgb_matrix_line_t;
+
+static void rgb_matrix_line_flush(rgb_matrix_line_t *line) {
+    RGB rgb[RGB_MATRIX_BATCH_SIZE];
+    rgb_matrix_hsv_to_rgb_batch(line->hsv, rgb, line->count);
+    for (uint8_t j = 0; j < line->count; j++) {
+        rgb_matrix_set_color(line->index[j], rgb[j].r, rgb[j].g, rgb[j].b);
+    }
+    line->count = 0;
+}
+
+static inline void rgb_matrix_line_add(rgb_matrix_line_t *line, uint8_t index, HSV hsv) {
+    line->index[line->count] = index;
+    line->hsv[line->count]   = hsv;
+    if (++line->count == RGB_MATRIX_BATCH_SIZE) {
+        rgb_matrix_line_flush(line);
+    }
+}
+
+#ifdef RGB_MATRIX_GEOMETRY_CACHE
+// Distance and angle of each LED from the center
+static uint8_t led_center_dist[DRIVER_LED_TOTAL];
+static uint8_t led_center_angle[DRIVER_LED_TOTAL];
+#    ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
+// Distance of each LED from a hit LED, one row for each LED hit last
+static uint8_t led_hit_row[LED_HITS_TO_REMEMBER];
+static uint8_t led_hit_dist[LED_HITS_TO_REMEMBER][DRIVER_LED_TOTAL];
+#    endif
+
+void rgb_matrix_update_led_geometry(void) {
+    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+        int16_t dx          = g_led_config.point[i].x - k_rgb_matrix_center.x;
+        int16_t dy          = g_led_config.point[i].y - k_rgb_matrix_center.y;
+        led_center_dist[i]  = sqrt16(dx * dx + dy * dy);
+        led_center_angle[i] = atan2_8(dy, dx);
+    }
+#    ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
+    memset(led_hit_row, NO_LED, sizeof(led_hit_row));
+#    endif
+}
+
+#    ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
+static bool led_is_hit(uint8_t led) {
+    for (uint8_t j = 0; j < g_last_hit_tracker.count; j++) {
+        if (g_last_hit_tracker.index[j] == led) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Returns the distances from a hit LED, filling a row the first time it is hit
+static const uint8_t *led_hit_distances(uint8_t led) {
+    uint8_t row;
+    for (row = 0; row < LED_HITS_TO_REMEMBER; row++) {
+        if (led_hit_row[row] == led) {
+            return led_hit_dist[row];
+        }
+    }
+
+    // there are as many rows as hits, so one of them isn't in use
+    for (row = 0; row < LED_HITS_TO_REMEMBER - 1; row++) {
+        if (led_hit_row[row] == NO_LED || !led_is_hit(led_hit_row[row])) {
+            break;
+        }
+    }
+    led_hit_row[row] = led;
+    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+        int16_t dx           = g_led_config.point[i].x - g_led_config.point[led].x;
+        int16_t dy           = g_led_config.point[i].y - g_led_config.point[led].y;
+        led_hit_dist[row][i] = sqrt16(dx * dx + dy * dy);
+    }
+    return led_hit_dist[row];
+}
+#    endif
+#endif
+
 // Generic effect runners
 #include "rgb_matrix_runners/effect_runner_dx_dy_dist.h"
 #include "rgb_matrix_runners/effect_runner_dx_dy.h"
+#include "rgb_matrix_runners/effect_runner_dist_angle.h"
+#include "rgb_matrix_runners/effect_runner_angle.h"
 #include "rgb_matrix_runners/effect_runner_i.h"
 #include "rgb_matrix_runners/effect_runner_sin_cos_i.h"
 #include "rgb_matrix_runners/effect_runner_reactive.h"
@@ -137,6 +232,11 @@ static rgb_task_states rgb_task_state    = SYNCING;
 static uint32_t rgb_anykey_timer;
 #endif  // RGB_DISABLE_TIMEOUT > 0
 
+// stats
+static rgb_matrix_stats_t rgb_stats;
+static uint16_t           rgb_fps_frames;
+static uint32_t           rgb_fps_timer;
+
 // double buffers
 static uint32_t rgb_timer_buffer;
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
@@ -294,11 +394,6 @@ static void rgb_task_timers(void) {
 #endif  // RGB_MATRIX_KEYREACTIVE_ENABLED
 }
 
-static void rgb_task_sync(void) {
-    // next task
-    if (timer_elapsed32(g_rgb_timer) >= RGB_MATRIX_LED_FLUSH_LIMIT) rgb_task_state = STARTING;
-}
-
 static void rgb_task_start(void) {
     // reset iter
     rgb_effect_params.iter = 0;
@@ -313,6 +408,21 @@ static void rgb_task_start(void) {
     rgb_task_state = RENDERING;
 }
 
+static void rgb_task_sync(void) {
+    uint32_t elapsed = timer_elapsed32(g_rgb_timer);
+
+    // next task, started right away so frames are RGB_MATRIX_LED_FLUSH_LIMIT apart
+    if (elapsed >= RGB_MATRIX_LED_FLUSH_LIMIT) {
+#if RGB_MATRIX_LED_FLUSH_LIMIT > 0
+        // the next frame is rendered for the current time, the ones missed in between are dropped
+        if (elapsed >= 2 * RGB_MATRIX_LED_FLUSH_LIMIT) {
+            rgb_stats.frames_skipped += elapsed / RGB_MATRIX_LED_FLUSH_LIMIT - 1;
+        }
+#endif
+        rgb_task_start();
+    }
+}
+
 static void rgb_task_render(uint8_t effect) {
     bool rendering         = false;
     rgb_effect_params.init = (effect != rgb_last_effect) || (rgb_matrix_config.enable != rgb_last_enable);
@@ -377,6 +487,14 @@ static void rgb_task_flush(uint8_t effect) {
     // update pwm buffers
     rgb_matrix_update_pwm_buffers();
 
+    rgb_fps_frames++;
+    uint32_t elapsed = timer_elapsed32(rgb_fps_timer);
+    if (elapsed >= 1000) {
+        rgb_stats.fps  = rgb_fps_frames * 1000UL / elapsed;
+        rgb_fps_frames = 0;
+        rgb_fps_timer  = timer_read32();
+    }
+
     // next task
     rgb_task_state = SYNCING;
 }
@@ -401,13 +519,25 @@ void rgb_matrix_task(void) {
         case STARTING:
             rgb_task_start();
             break;
-        case RENDERING:
-            rgb_task_render(effect);
-            if (effect) {
-                rgb_matrix_indicators();
-                rgb_matrix_indicators_advanced(&rgb_effect_params);
+        case RENDERING: {
+#ifdef RGB_MATRIX_RENDER_BUDGET
+            // keep rendering from where the last run stopped until the frame is done or the budget is spent
+            uint32_t start = timer_read32();
+            do {
+#endif
+                rgb_task_render(effect);
+                if (effect) {
+                    rgb_matrix_indicators();
+                    rgb_matrix_indicators_advanced(&rgb_effect_params);
+                }
+#ifdef RGB_MATRIX_RENDER_BUDGET
+            } while (rgb_task_state == RENDERING && timer_elapsed32(start) < RGB_MATRIX_RENDER_BUDGET);
+            if (timer_elapsed32(start) > RGB_MATRIX_RENDER_BUDGET) {
+                rgb_stats.budget_overruns++;
             }
+#endif
             break;
+        }
         case FLUSHING:
             rgb_task_flush(effect);
             break;
@@ -451,6 +581,10 @@ __attribute__((weak)) void rgb_matrix_indicators_advanced_user(uint8_t led_min,
 void rgb_matrix_init(void) {
     rgb_matrix_driver.init();
 
+#ifdef RGB_MATRIX_GEOMETRY_CACHE
+    rgb_matrix_update_led_geometry();
+#endif
+
 #ifdef RGB_MATRIX_KEYREACTIVE_ENABLED
     g_last_hit_tracker.count = 0;
     for (uint8_t i = 0; i < LED_HITS_TO_REMEMBER; ++i) {
@@ -619,6 +753,14 @@ void rgb_matrix_decrease_speed_helper(bool write_to_eeprom) { rgb_matrix_set_spe
 void rgb_matrix_decrease_speed_noeeprom(void) { rgb_matrix_decrease_speed_helper(false); }
 void rgb_matrix_decrease_speed(void) { rgb_matrix_decrease_speed_helper(true); }
 
+const rgb_matrix_stats_t *rgb_matrix_get_stats(void) { return &rgb_stats; }
+
+void rgb_matrix_clear_stats(void) {
+    rgb_stats      = (rgb_matrix_stats_t){0};
+    rgb_fps_frames = 0;
+    rgb_fps_timer  = timer_read32();
+}
+
 led_flags_t rgb_matrix_get_flags(void) { return rgb_effect_params.flags; }
 
 void rgb_matrix_set_flags(led_flags_t flags) { rgb_effect_params.flags = flags; }
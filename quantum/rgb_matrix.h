@@ -38,7 +38,15 @@
 #endif
 
 #ifndef RGB_MATRIX_LED_FLUSH_LIMIT
-#    define RGB_MATRIX_LED_FLUSH_LIMIT 16
+#    ifdef RGB_MATRIX_TARGET_FPS
+#        define RGB_MATRIX_LED_FLUSH_LIMIT (1000 / RGB_MATRIX_TARGET_FPS)
+#    else
+#        define RGB_MATRIX_LED_FLUSH_LIMIT 16
+#    endif
+#endif
+
+#ifndef RGB_MATRIX_BATCH_SIZE
+#    define RGB_MATRIX_BATCH_SIZE 16
 #endif
 
 #ifndef RGB_MATRIX_LED_PROCESS_LIMIT
@@ -114,6 +122,11 @@ void rgb_matrix_indicators_advanced_user(uint8_t led_min, uint8_t led_max);
 
 void rgb_matrix_init(void);
 
+#ifdef RGB_MATRIX_GEOMETRY_CACHE
+// Call after changing g_led_config.point at runtime
+void rgb_matrix_update_led_geometry(void);
+#endif
+
 void        rgb_matrix_set_suspend_state(bool state);
 bool        rgb_matrix_get_suspend_state(void);
 void        rgb_matrix_toggle(void);
@@ -158,6 +171,16 @@ void        rgb_matrix_decrease_speed_noeeprom(void);
 led_flags_t rgb_matrix_get_flags(void);
 void        rgb_matrix_set_flags(led_flags_t flags);
 
+typedef struct {
+    uint16_t fps;              // frames flushed over the last second
+    uint32_t frames_skipped;   // frames dropped because the previous one took too long
+    uint32_t budget_overruns;  // task runs that rendered past RGB_MATRIX_RENDER_BUDGET
+} rgb_matrix_stats_t;
+
+// Rendering statistics since the last clear
+const rgb_matrix_stats_t *rgb_matrix_get_stats(void);
+void                      rgb_matrix_clear_stats(void);
+
 #ifndef RGBLIGHT_ENABLE
 #    define eeconfig_update_rgblight_current eeconfig_update_rgb_matrix
 #    define rgblight_toggle rgb_matrix_toggle
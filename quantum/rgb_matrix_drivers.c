@@ -142,16 +142,29 @@ const rgb_matrix_driver_t rgb_matrix_driver = {
 
 // LED color buffer
 LED_TYPE rgb_matrix_ws2812_array[DRIVER_LED_TOTAL];
+// The strip can only be written as a whole, so only track whether anything changed
+static bool ws2812_dirty = true;
 
 static void init(void) {}
 
 static void flush(void) {
+    if (!ws2812_dirty) {
+        return;
+    }
     // Assumes use of RGB_DI_PIN
     ws2812_setleds(rgb_matrix_ws2812_array, DRIVER_LED_TOTAL);
+    ws2812_dirty = false;
 }
 
 // Set an led in the buffer to a color
 static inline void setled(int i, uint8_t r, uint8_t g, uint8_t b) {
+#    ifndef RGBW
+    // The RGBW conversion changes the stored values, so those are always sent
+    if (rgb_matrix_ws2812_array[i].r == r && rgb_matrix_ws2812_array[i].g == g && rgb_matrix_ws2812_array[i].b == b) {
+        return;
+    }
+#    endif
+    ws2812_dirty                 = true;
     rgb_matrix_ws2812_array[i].r = r;
     rgb_matrix_ws2812_array[i].g = g;
     rgb_matrix_ws2812_array[i].b = b;
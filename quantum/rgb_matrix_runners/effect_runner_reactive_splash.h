@@ -7,7 +7,16 @@ typedef HSV (*reactive_splash_f)(HSV hsv, int16_t dx, int16_t dy, uint8_t dist,
 bool effect_runner_reactive_splash(uint8_t start, effect_params_t* params, reactive_splash_f effect_func) {
     RGB_MATRIX_USE_LIMITS(led_min, led_max);
 
+    rgb_matrix_line_t line;
+    line.count = 0;
+
     uint8_t count = g_last_hit_tracker.count;
+#    ifdef RGB_MATRIX_GEOMETRY_CACHE
+    const uint8_t* hit_dist[LED_HITS_TO_REMEMBER];
+    for (uint8_t j = start; j < count; j++) {
+        hit_dist[j] = led_hit_distances(g_last_hit_tracker.index[j]);
+    }
+#    endif
     for (uint8_t i = led_min; i < led_max; i++) {
         RGB_MATRIX_TEST_LED_FLAGS();
         HSV hsv = rgb_matrix_config.hsv;
@@ -15,14 +24,18 @@ bool effect_runner_reactive_splash(uint8_t start, effect_params_t* params, react
         for (uint8_t j = start; j < count; j++) {
             int16_t  dx   = g_led_config.point[i].x - g_last_hit_tracker.x[j];
             int16_t  dy   = g_led_config.point[i].y - g_last_hit_tracker.y[j];
+#    ifdef RGB_MATRIX_GEOMETRY_CACHE
+            uint8_t  dist = hit_dist[j][i];
+#    else
             uint8_t  dist = sqrt16(dx * dx + dy * dy);
+#    endif
             uint16_t tick = scale16by8(g_last_hit_tracker.tick[j], rgb_matrix_config.speed);
             hsv           = effect_func(hsv, dx, dy, dist, tick);
         }
-        hsv.v   = scale8(hsv.v, rgb_matrix_config.hsv.v);
-        RGB rgb = rgb_matrix_hsv_to_rgb(hsv);
-        rgb_matrix_set_color(i, rgb.r, rgb.g, rgb.b);
+        hsv.v = scale8(hsv.v, rgb_matrix_config.hsv.v);
+        rgb_matrix_line_add(&line, i, hsv);
     }
+    rgb_matrix_line_flush(&line);
     return led_max < DRIVER_LED_TOTAL;
 }
 
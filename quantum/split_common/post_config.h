@@ -16,4 +16,9 @@
 // When using serial and RGBLIGHT_SPLIT need separate transaction
 #        define SERIAL_USE_MULTI_TRANSACTION
 #    endif
+
+// The delta transport uses one transaction per register
+#    if defined(SPLIT_TRANSPORT_DELTA) && !defined(SERIAL_USE_MULTI_TRANSACTION)
+#        define SERIAL_USE_MULTI_TRANSACTION
+#    endif
 #endif
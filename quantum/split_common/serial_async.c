@@ -0,0 +1,126 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+
+#include "serial_async.h"
+#include "timer.h"
+
+#define HANDSHAKE_MAGIC 7
+
+enum serial_async_state {
+    SERIAL_ASYNC_IDLE,
+    SERIAL_ASYNC_HANDSHAKE,
+    SERIAL_ASYNC_TRANSFER,
+};
+
+static SSTD_t *transaction_table      = NULL;
+static uint8_t transaction_table_size = 0;
+
+static uint8_t  state       = SERIAL_ASYNC_IDLE;
+static uint8_t  last_result = TRANSACTION_END;
+static SSTD_t * transaction;
+static uint8_t  transaction_id;
+static uint8_t  handshake;
+static uint16_t start_time;
+
+static const uint8_t *tx;
+static uint8_t        tx_left;
+static uint8_t *      rx;
+static uint8_t        rx_left;
+
+void serial_async_init(SSTD_t *sstd_table, uint8_t sstd_table_size) {
+    transaction_table      = sstd_table;
+    transaction_table_size = sstd_table_size;
+    state                  = SERIAL_ASYNC_IDLE;
+    last_result            = TRANSACTION_END;
+}
+
+bool soft_serial_transaction_start(int sstd_index) {
+    if (state != SERIAL_ASYNC_IDLE || sstd_index >= transaction_table_size) {
+        return false;
+    }
+
+    transaction    = &transaction_table[sstd_index];
+    transaction_id = sstd_index;
+    serial_async_phy_clear();
+
+    // First chunk is always the transaction id, which the target sends back as a handshake
+    tx         = &transaction_id;
+    tx_left    = sizeof(transaction_id);
+    rx         = &handshake;
+    rx_left    = sizeof(handshake);
+    state      = SERIAL_ASYNC_HANDSHAKE;
+    start_time = timer_read();
+    return true;
+}
+
+static int finish(int result) {
+    state       = SERIAL_ASYNC_IDLE;
+    last_result = result;
+    if (transaction->status) {
+        *transaction->status = result;
+    }
+    return result;
+}
+
+int soft_serial_transaction_poll(void) {
+    if (state == SERIAL_ASYNC_IDLE) {
+        return last_result;
+    }
+
+    bool progress;
+    do {
+        progress = false;
+        if (tx_left) {
+            uint8_t n = serial_async_phy_write(tx, tx_left);
+            tx += n;
+            tx_left -= n;
+            progress |= n;
+        }
+        if (rx_left) {
+            uint8_t n = serial_async_phy_read(rx, rx_left);
+            rx += n;
+            rx_left -= n;
+            progress |= n;
+        }
+        if (tx_left || rx_left) {
+            continue;
+        }
+
+        switch (state) {
+            case SERIAL_ASYNC_HANDSHAKE:
+                if (handshake != (transaction_id ^ HANDSHAKE_MAGIC)) {
+                    return finish(TRANSACTION_NO_RESPONSE);
+                }
+                // The target answers once it has read everything we send
+                tx       = transaction->initiator2target_buffer;
+                tx_left  = transaction->initiator2target_buffer_size;
+                rx       = transaction->target2initiator_buffer;
+                rx_left  = transaction->target2initiator_buffer_size;
+                state    = SERIAL_ASYNC_TRANSFER;
+                progress = true;
+                break;
+            case SERIAL_ASYNC_TRANSFER:
+                return finish(TRANSACTION_END);
+        }
+    } while (progress);
+
+    if (timer_elapsed(start_time) > SERIAL_ASYNC_TIMEOUT) {
+        return finish(TRANSACTION_NO_RESPONSE);
+    }
+    return TRANSACTION_BUSY;
+}
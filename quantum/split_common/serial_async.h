@@ -0,0 +1,42 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "serial.h"
+
+/* Non-blocking soft serial initiator.
+ *
+ * soft_serial_transaction_start() queues a transaction and returns at once,
+ * soft_serial_transaction_poll() moves it forward with whatever bytes the link
+ * has sent or received since, so a transfer can run across several matrix
+ * scans instead of blocking one.
+ */
+
+#ifndef SERIAL_ASYNC_TIMEOUT
+#    define SERIAL_ASYNC_TIMEOUT 100
+#endif
+
+void serial_async_init(SSTD_t *sstd_table, uint8_t sstd_table_size);
+
+// Physical layer, implemented by the serial driver. Reads and writes never wait,
+// and return the number of bytes actually transferred.
+void    serial_async_phy_clear(void);
+uint8_t serial_async_phy_write(const uint8_t *data, uint8_t size);
+uint8_t serial_async_phy_read(uint8_t *data, uint8_t size);
@@ -0,0 +1,28 @@
+split_transport_delta_DEFS := \
+	-DSPLIT_TRANSPORT_DELTA \
+	-DSPLIT_TRANSPORT_LOOPBACK \
+	-DBACKLIGHT_ENABLE
+
+split_transport_delta_INC := \
+	$(QUANTUM_PATH)/split_common/tests \
+	$(QUANTUM_PATH)/split_common \
+	$(QUANTUM_PATH)/backlight \
+	$(TMK_PATH)/common
+
+split_transport_delta_SRC := \
+	$(QUANTUM_PATH)/split_common/tests/transport_delta_tests.cpp \
+	$(QUANTUM_PATH)/split_common/transport_delta.c
+
+split_serial_async_DEFS := \
+	-DSERIAL_USE_MULTI_TRANSACTION \
+	-DSERIAL_USE_ASYNC_TRANSACTION
+
+split_serial_async_INC := \
+	$(QUANTUM_PATH)/split_common \
+	$(DRIVER_PATH)/chibios \
+	$(TMK_PATH)/common
+
+split_serial_async_SRC := \
+	$(QUANTUM_PATH)/split_common/tests/serial_async_tests.cpp \
+	$(QUANTUM_PATH)/split_common/serial_async.c \
+	$(TMK_PATH)/common/test/timer.c
@@ -0,0 +1,220 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <deque>
+#include <vector>
+
+extern "C" {
+#include "serial_async.h"
+#include "timer.h"
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+}
+
+namespace {
+// A half duplex wire with a target on the other end. Bytes move in both
+// directions at bytes_per_tick, the target answers the way the usart driver's
+// slave thread does.
+struct SimulatedLink {
+    std::deque<uint8_t> to_target;
+    std::deque<uint8_t> to_initiator;
+    unsigned            tx_queue_size  = 16;
+    unsigned            bytes_per_tick = 1;
+    bool                connected      = true;
+    uint8_t             handshake_xor  = 7;
+
+    SSTD_t *table;
+    enum { WAIT_ID, READ_I2T } target_state = WAIT_ID;
+    SSTD_t * target_transaction;
+    unsigned target_received;
+
+    void target_byte(uint8_t byte) {
+        switch (target_state) {
+            case WAIT_ID:
+                target_transaction = &table[byte];
+                to_initiator.push_back(byte ^ handshake_xor);
+                target_received = 0;
+                target_state    = READ_I2T;
+                break;
+            case READ_I2T:
+                target_transaction->initiator2target_buffer[target_received++] = byte;
+                break;
+        }
+        if (target_state == READ_I2T && target_received == target_transaction->initiator2target_buffer_size) {
+            for (unsigned i = 0; i < target_transaction->target2initiator_buffer_size; i++) {
+                to_initiator.push_back(target_transaction->target2initiator_buffer[i]);
+            }
+            target_state = WAIT_ID;
+        }
+    }
+
+    void tick() {
+        for (unsigned i = 0; i < bytes_per_tick && !to_target.empty(); i++) {
+            uint8_t byte = to_target.front();
+            to_target.pop_front();
+            if (connected) {
+                target_byte(byte);
+            }
+        }
+    }
+};
+
+SimulatedLink *wire;
+
+// Initiator and target each have their own buffers
+uint8_t m2s_initiator[4], m2s_target[4];
+uint8_t s2m_initiator[6], s2m_target[6];
+uint8_t status_initiator, status_target;
+
+SSTD_t initiator_table[] = {
+    {&status_initiator, sizeof(m2s_initiator), m2s_initiator, sizeof(s2m_initiator), s2m_initiator},
+    {&status_initiator, sizeof(m2s_initiator), m2s_initiator, 0, NULL},
+};
+SSTD_t target_table[] = {
+    {&status_target, sizeof(m2s_target), m2s_target, sizeof(s2m_target), s2m_target},
+    {&status_target, sizeof(m2s_target), m2s_target, 0, NULL},
+};
+}  // namespace
+
+extern "C" {
+void serial_async_phy_clear(void) { wire->to_initiator.clear(); }
+
+uint8_t serial_async_phy_write(const uint8_t *data, uint8_t size) {
+    uint8_t n = 0;
+    while (n < size && wire->to_target.size() < wire->tx_queue_size) {
+        wire->to_target.push_back(data[n++]);
+    }
+    return n;
+}
+
+uint8_t serial_async_phy_read(uint8_t *data, uint8_t size) {
+    uint8_t n = 0;
+    while (n < size && !wire->to_initiator.empty()) {
+        data[n++] = wire->to_initiator.front();
+        wire->to_initiator.pop_front();
+    }
+    return n;
+}
+}
+
+class SerialAsync : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        wire      = &sim;
+        sim.table = target_table;
+        set_time(0);
+        serial_async_init(initiator_table, sizeof(initiator_table) / sizeof(SSTD_t));
+        for (unsigned i = 0; i < sizeof(m2s_initiator); i++) {
+            m2s_initiator[i] = 0x10 + i;
+            m2s_target[i]    = 0;
+        }
+        for (unsigned i = 0; i < sizeof(s2m_target); i++) {
+            s2m_target[i]    = 0xA0 + i;
+            s2m_initiator[i] = 0;
+        }
+    }
+
+    // Runs scans of 1ms until the transaction finishes, returns its result
+    int run(unsigned *scans) {
+        int result;
+        *scans = 0;
+        do {
+            sim.tick();
+            uint32_t before = timer_read32();
+            result          = soft_serial_transaction_poll();
+            // polling never waits
+            EXPECT_EQ(timer_read32(), before);
+            advance_time(1);
+            ++*scans;
+        } while (result == TRANSACTION_BUSY && *scans < 1000);
+        return result;
+    }
+
+    SimulatedLink sim;
+};
+
+TEST_F(SerialAsync, TransactionRunsAcrossScans) {
+    unsigned scans;
+    ASSERT_TRUE(soft_serial_transaction_start(0));
+    EXPECT_EQ(run(&scans), TRANSACTION_END);
+    // the id and 4 bytes go out at one byte per scan
+    EXPECT_GE(scans, 5u);
+    EXPECT_EQ(status_initiator, TRANSACTION_END);
+    EXPECT_EQ(0, memcmp(m2s_target, m2s_initiator, sizeof(m2s_target)));
+    EXPECT_EQ(0, memcmp(s2m_initiator, s2m_target, sizeof(s2m_target)));
+}
+
+TEST_F(SerialAsync, FastLinkFinishesInOnePoll) {
+    unsigned scans;
+    sim.bytes_per_tick = 64;
+    sim.tx_queue_size  = 64;
+    ASSERT_TRUE(soft_serial_transaction_start(0));
+    // the first poll queues the id, the second finds the answer
+    EXPECT_EQ(run(&scans), TRANSACTION_END);
+    EXPECT_LE(scans, 3u);
+    EXPECT_EQ(0, memcmp(s2m_initiator, s2m_target, sizeof(s2m_target)));
+}
+
+TEST_F(SerialAsync, WriteOnlyTransaction) {
+    unsigned scans;
+    ASSERT_TRUE(soft_serial_transaction_start(1));
+    EXPECT_EQ(run(&scans), TRANSACTION_END);
+    // done once everything is queued, the wire still has to deliver it
+    while (!sim.to_target.empty()) {
+        sim.tick();
+    }
+    EXPECT_EQ(0, memcmp(m2s_target, m2s_initiator, sizeof(m2s_target)));
+}
+
+TEST_F(SerialAsync, SmallTransmitQueue) {
+    unsigned scans;
+    sim.tx_queue_size = 1;
+    ASSERT_TRUE(soft_serial_transaction_start(0));
+    EXPECT_EQ(run(&scans), TRANSACTION_END);
+    EXPECT_EQ(0, memcmp(m2s_target, m2s_initiator, sizeof(m2s_target)));
+    EXPECT_EQ(0, memcmp(s2m_initiator, s2m_target, sizeof(s2m_target)));
+}
+
+TEST_F(SerialAsync, OnlyOneTransactionAtATime) {
+    unsigned scans;
+    ASSERT_TRUE(soft_serial_transaction_start(0));
+    EXPECT_FALSE(soft_serial_transaction_start(1));
+    EXPECT_EQ(run(&scans), TRANSACTION_END);
+    EXPECT_TRUE(soft_serial_transaction_start(1));
+    EXPECT_EQ(run(&scans), TRANSACTION_END);
+}
+
+TEST_F(SerialAsync, UnknownTransactionIsRejected) { EXPECT_FALSE(soft_serial_transaction_start(2)); }
+
+TEST_F(SerialAsync, DisconnectedTargetTimesOut) {
+    unsigned scans;
+    sim.connected = false;
+    ASSERT_TRUE(soft_serial_transaction_start(0));
+    EXPECT_EQ(run(&scans), TRANSACTION_NO_RESPONSE);
+    EXPECT_GT(scans, (unsigned)SERIAL_ASYNC_TIMEOUT);
+    EXPECT_EQ(status_initiator, TRANSACTION_NO_RESPONSE);
+    // the result stays until the next transaction
+    EXPECT_EQ(soft_serial_transaction_poll(), TRANSACTION_NO_RESPONSE);
+}
+
+TEST_F(SerialAsync, WrongHandshakeFails) {
+    unsigned scans;
+    sim.handshake_xor = 3;
+    ASSERT_TRUE(soft_serial_transaction_start(0));
+    EXPECT_EQ(run(&scans), TRANSACTION_NO_RESPONSE);
+    EXPECT_LT(scans, 10u);
+}
@@ -0,0 +1,246 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <random>
+
+extern "C" {
+#include "config.h"
+#include "transport.h"
+}
+
+#define ROWS_PER_HAND (MATRIX_ROWS / 2)
+
+enum { REG_STATUS, REG_DATA, REG_ACK, REG_SYNC };
+
+static uint8_t backlight_level;
+static int     backlight_level_on_slave;
+static int     backlight_set_calls;
+
+extern "C" {
+bool    is_backlight_enabled(void) { return true; }
+uint8_t get_backlight_level(void) { return backlight_level; }
+void    backlight_set(uint8_t level) {
+    backlight_level_on_slave = level;
+    backlight_set_calls++;
+}
+}
+
+class SplitTransportDelta : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        transport_master_init();
+        transport_slave_init();
+        backlight_level          = 0;
+        backlight_level_on_slave = -1;
+        backlight_set_calls      = 0;
+        memset(slave, 0, sizeof(slave));
+        memset(master, 0, sizeof(master));
+    }
+
+    // One slave loop followed by one master scan
+    bool exchange() {
+        transport_slave(slave);
+        return transport_master(master);
+    }
+
+    void expect_in_sync() {
+        for (int i = 0; i < ROWS_PER_HAND; i++) {
+            EXPECT_EQ(master[i], slave[i]) << "row " << i;
+        }
+    }
+
+    const split_transport_stats_t &stats() { return *split_transport_get_stats(); }
+
+    matrix_row_t slave[ROWS_PER_HAND];
+    matrix_row_t master[ROWS_PER_HAND];
+};
+
+TEST_F(SplitTransportDelta, FirstExchangeSendsAllRows) {
+    for (int i = 0; i < ROWS_PER_HAND; i++) {
+        slave[i] = 0x101 * (i + 1);
+    }
+    EXPECT_TRUE(exchange());
+    expect_in_sync();
+    EXPECT_EQ(stats().full_frames, 1u);
+}
+
+TEST_F(SplitTransportDelta, UnchangedMatrixOnlyReadsStatus) {
+    slave[1] = 0x0F0;
+    ASSERT_TRUE(exchange());
+    // The slave picks up the ack
+    ASSERT_TRUE(exchange());
+    split_transport_clear_stats();
+
+    for (int i = 0; i < 100; i++) {
+        ASSERT_TRUE(exchange());
+    }
+    expect_in_sync();
+    EXPECT_EQ(stats().transfers, 100u);
+    EXPECT_LT(stats().bytes, 100u * (sizeof(matrix_row_t) * ROWS_PER_HAND));
+}
+
+TEST_F(SplitTransportDelta, ChangedRowIsSentAlone) {
+    ASSERT_TRUE(exchange());
+    ASSERT_TRUE(exchange());
+    uint32_t unchanged_bytes;
+    split_transport_clear_stats();
+    ASSERT_TRUE(exchange());
+    unchanged_bytes = stats().bytes;
+
+    split_transport_clear_stats();
+    slave[3] = 0x800;
+    ASSERT_TRUE(exchange());
+    expect_in_sync();
+    EXPECT_EQ(stats().full_frames, 0u);
+    // status, data and ack
+    EXPECT_EQ(stats().transfers, 3u);
+    uint32_t one_row_bytes = stats().bytes - unchanged_bytes;
+
+    split_transport_clear_stats();
+    slave[0] = 0x001;
+    slave[4] = 0x002;
+    ASSERT_TRUE(exchange());
+    expect_in_sync();
+    EXPECT_EQ(stats().bytes - unchanged_bytes, one_row_bytes + sizeof(matrix_row_t));
+}
+
+TEST_F(SplitTransportDelta, CorruptedFramesAreRetried) {
+    ASSERT_TRUE(exchange());
+    ASSERT_TRUE(exchange());
+    split_transport_clear_stats();
+
+    slave[2] = 0x123;
+    split_transport_loopback_inject_errors(REG_STATUS, 1);
+    split_transport_loopback_inject_errors(REG_DATA, 1);
+    ASSERT_TRUE(exchange());
+    expect_in_sync();
+    EXPECT_EQ(stats().crc_errors, 2u);
+    EXPECT_EQ(stats().retries, 2u);
+}
+
+TEST_F(SplitTransportDelta, LinkFailureRecoversWithAllRows) {
+    ASSERT_TRUE(exchange());
+    slave[1] = 0x055;
+    split_transport_loopback_inject_errors(REG_STATUS, 10);
+    EXPECT_FALSE(exchange());
+    split_transport_loopback_inject_errors(REG_STATUS, 0);
+
+    split_transport_clear_stats();
+    slave[2] = 0x0AA;
+    // The master asks for every row, the slave sends them on its next loop
+    EXPECT_FALSE(exchange());
+    EXPECT_TRUE(exchange());
+    EXPECT_EQ(stats().full_frames, 1u);
+    expect_in_sync();
+}
+
+TEST_F(SplitTransportDelta, LostAckKeepsHalvesInSync) {
+    ASSERT_TRUE(exchange());
+    ASSERT_TRUE(exchange());
+
+    // The slave never sees the ack for this change
+    slave[0] = 0x00F;
+    split_transport_loopback_inject_errors(REG_ACK, 1);
+    ASSERT_TRUE(exchange());
+    expect_in_sync();
+
+    // Reverting the row must still reach the master
+    slave[0] = 0;
+    ASSERT_TRUE(exchange());
+    ASSERT_TRUE(exchange());
+    expect_in_sync();
+}
+
+TEST_F(SplitTransportDelta, SlaveResetIsNotMistakenForTheOldState) {
+    slave[1] = 0x0F0;
+    ASSERT_TRUE(exchange());
+    ASSERT_TRUE(exchange());
+
+    // The restarted slave publishes the same sequence number the master has
+    transport_slave_init();
+    slave[1] = 0;
+    slave[2] = 0x00C;
+    ASSERT_TRUE(exchange());
+    expect_in_sync();
+
+    // and sends changes relative to the new rows afterwards
+    slave[3] = 0x300;
+    ASSERT_TRUE(exchange());
+    ASSERT_TRUE(exchange());
+    expect_in_sync();
+}
+
+TEST_F(SplitTransportDelta, SlaveFasterThanMaster) {
+    ASSERT_TRUE(exchange());
+    for (int i = 0; i < 20; i++) {
+        slave[i % ROWS_PER_HAND] ^= 1 << (i % MATRIX_COLS);
+        transport_slave(slave);
+        transport_slave(slave);
+        slave[(i + 2) % ROWS_PER_HAND] ^= 1 << ((i + 3) % MATRIX_COLS);
+        ASSERT_TRUE(exchange());
+        ASSERT_TRUE(exchange());
+        expect_in_sync();
+    }
+}
+
+TEST_F(SplitTransportDelta, SyncIsSentOnceWhenChanged) {
+    ASSERT_TRUE(exchange());
+    ASSERT_TRUE(exchange());
+    backlight_set_calls = 0;
+    split_transport_clear_stats();
+
+    backlight_level = 3;
+    for (int i = 0; i < 10; i++) {
+        ASSERT_TRUE(exchange());
+    }
+    EXPECT_EQ(backlight_level_on_slave, 3);
+    EXPECT_EQ(backlight_set_calls, 1);
+    // one sync write, and a second one before the slave reported it
+    EXPECT_LE(stats().transfers, 12u);
+}
+
+TEST_F(SplitTransportDelta, CorruptedSyncIsSentAgain) {
+    ASSERT_TRUE(exchange());
+    backlight_level = 5;
+    split_transport_loopback_inject_errors(REG_SYNC, 1);
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(exchange());
+    }
+    EXPECT_EQ(backlight_level_on_slave, 5);
+}
+
+TEST_F(SplitTransportDelta, RandomChangesAndErrors) {
+    std::mt19937 rng(1234);
+    for (int i = 0; i < 2000; i++) {
+        if (rng() % 3 == 0) {
+            slave[rng() % ROWS_PER_HAND] ^= 1 << (rng() % MATRIX_COLS);
+        }
+        if (rng() % 10 == 0) {
+            split_transport_loopback_inject_errors(rng() % 4, 1 + rng() % 2);
+        }
+        exchange();
+    }
+    split_transport_loopback_inject_errors(REG_STATUS, 0);
+    split_transport_loopback_inject_errors(REG_DATA, 0);
+    split_transport_loopback_inject_errors(REG_ACK, 0);
+    split_transport_loopback_inject_errors(REG_SYNC, 0);
+    for (int i = 0; i < 3; i++) {
+        exchange();
+    }
+    ASSERT_TRUE(exchange());
+    expect_in_sync();
+}
@@ -221,18 +221,7 @@ void transport_rgblight_slave(void) {
 #        define transport_rgblight_slave()
 #    endif
 
-bool transport_master(matrix_row_t matrix[]) {
-#    ifndef SERIAL_USE_MULTI_TRANSACTION
-    if (soft_serial_transaction() != TRANSACTION_END) {
-        return false;
-    }
-#    else
-    transport_rgblight_master();
-    if (soft_serial_transaction(GET_SLAVE_MATRIX) != TRANSACTION_END) {
-        return false;
-    }
-#    endif
-
+static void transport_master_update(matrix_row_t matrix[]) {
     // TODO:  if MATRIX_COLS > 8 change to unpack()
     for (int i = 0; i < ROWS_PER_HAND; ++i) {
         matrix[i] = serial_s2m_buffer.smatrix[i];
@@ -251,8 +240,72 @@ bool transport_master(matrix_row_t matrix[]) {
     // Write wpm to slave
     serial_m2s_buffer.current_wpm = get_current_wpm();
 #    endif
+}
+
+// serial_async.c is only built for the usart driver
+#    if defined(SERIAL_USE_ASYNC_TRANSACTION) && !defined(SERIAL_DRIVER_USART)
+#        error "SERIAL_USE_ASYNC_TRANSACTION needs SERIAL_DRIVER = usart"
+#    endif
+
+#    ifndef SERIAL_USE_ASYNC_TRANSACTION
+bool transport_master(matrix_row_t matrix[]) {
+#        ifndef SERIAL_USE_MULTI_TRANSACTION
+    if (soft_serial_transaction() != TRANSACTION_END) {
+        return false;
+    }
+#        else
+    transport_rgblight_master();
+    if (soft_serial_transaction(GET_SLAVE_MATRIX) != TRANSACTION_END) {
+        return false;
+    }
+#        endif
+
+    transport_master_update(matrix);
     return true;
 }
+#    else
+// The transaction started in one scan is collected in the next, so the
+// transfer runs while the matrix is being scanned. The rows from the last
+// completed transaction are kept until then.
+static int8_t async_transaction = -1;
+
+bool transport_master(matrix_row_t matrix[]) {
+    bool ok = true;
+
+    if (async_transaction >= 0) {
+        int status = soft_serial_transaction_poll();
+        if (status == TRANSACTION_BUSY) {
+            return true;
+        }
+
+        if (async_transaction == GET_SLAVE_MATRIX) {
+            if (status == TRANSACTION_END) {
+                transport_master_update(matrix);
+            } else {
+                ok = false;
+            }
+        }
+#        if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
+        else if (status == TRANSACTION_END) {
+            rgblight_clear_change_flags();
+        }
+#        endif
+    }
+
+#        if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
+    // rgblight sync goes in between matrix reads
+    if (async_transaction != PUT_RGBLIGHT && rgblight_get_change_flags()) {
+        rgblight_get_syncinfo((rgblight_syncinfo_t *)&serial_rgblight.rgblight_sync);
+        async_transaction = PUT_RGBLIGHT;
+    } else
+#        endif
+    {
+        async_transaction = GET_SLAVE_MATRIX;
+    }
+    soft_serial_transaction_start(async_transaction);
+    return ok;
+}
+#    endif
 
 void transport_slave(matrix_row_t matrix[]) {
     transport_rgblight_slave();
@@ -8,3 +8,22 @@ void transport_slave_init(void);
 // returns false if valid data not received from slave
 bool transport_master(matrix_row_t matrix[]);
 void transport_slave(matrix_row_t matrix[]);
+
+#ifdef SPLIT_TRANSPORT_DELTA
+typedef struct {
+    uint32_t transfers;
+    uint32_t bytes;
+    uint32_t retries;
+    uint32_t crc_errors;
+    uint32_t full_frames;
+} split_transport_stats_t;
+
+// Link statistics on the master, since the last clear
+const split_transport_stats_t *split_transport_get_stats(void);
+void                           split_transport_clear_stats(void);
+
+#    ifdef SPLIT_TRANSPORT_LOOPBACK
+// Corrupts the next count transfers of a register (0: status, 1: data, 2: ack, 3: sync)
+void split_transport_loopback_inject_errors(uint8_t reg, uint8_t count);
+#    endif
+#endif
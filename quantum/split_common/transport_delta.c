@@ -0,0 +1,562 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Split transport that only sends what changed.
+ *
+ * The slave exposes a small register file that the master reads and writes:
+ *  - status (slave to master): sequence number, which rows changed, and which
+ *    sync packet was applied. This is the only transfer while nothing changes.
+ *    A session flag, cleared when the slave starts, tells the master whether
+ *    the slave has heard from it since, so a slave that reset and counted up
+ *    to the same sequence number isn't taken for the old one.
+ *  - data (slave to master): encoder state and the changed rows, read only
+ *    when the sequence number moved.
+ *  - ack (master to slave): the sequence number the master has applied, so the
+ *    slave can send rows relative to it, or a request for all rows.
+ *  - sync (master to slave): backlight, WPM and RGB state, written only when
+ *    one of them changed, with a dirty flag per field.
+ *
+ * Every frame starts with a CRC8 of the rest of the frame. The master retries
+ * failed reads, and writes the sync packet again until the slave reports it.
+ */
+
+#include <string.h>
+#include <stddef.h>
+
+#include "config.h"
+#include "matrix.h"
+#include "transport.h"
+
+#define ROWS_PER_HAND (MATRIX_ROWS / 2)
+
+#ifdef RGBLIGHT_ENABLE
+#    include "rgblight.h"
+#endif
+
+#ifdef BACKLIGHT_ENABLE
+#    include "backlight.h"
+#endif
+
+#ifdef WPM_ENABLE
+#    include "wpm.h"
+#endif
+
+#ifdef ENCODER_ENABLE
+#    include "encoder.h"
+static pin_t encoders_pad[] = ENCODERS_PAD_A;
+#    define NUMBER_OF_ENCODERS (sizeof(encoders_pad) / sizeof(pin_t))
+#endif
+
+#define SPLIT_PROTOCOL_VERSION 2
+
+#ifndef SPLIT_TRANSPORT_RETRIES
+#    define SPLIT_TRANSPORT_RETRIES 2
+#endif
+
+/* Number of published states the slave remembers, so an ack for a state it has since replaced still counts */
+#ifndef SPLIT_TRANSPORT_HISTORY
+#    define SPLIT_TRANSPORT_HISTORY 4
+#endif
+
+#define ROW_MASK_BYTES ((ROWS_PER_HAND + 7) / 8)
+
+/* status flags */
+#define SPLIT_STATUS_FULL (1 << 0)     // data holds every row, not only the ones changed since base_seq
+#define SPLIT_STATUS_SESSION (1 << 1)  // the slave received an ack since it started
+/* ack flags */
+#define SPLIT_ACK_REQUEST_FULL (1 << 0)
+/* sync dirty flags */
+#define SPLIT_SYNC_BACKLIGHT (1 << 0)
+#define SPLIT_SYNC_WPM (1 << 1)
+#define SPLIT_SYNC_RGBLIGHT (1 << 2)
+
+typedef struct {
+    uint8_t crc;
+    uint8_t version;
+    uint8_t seq;
+    uint8_t base_seq;
+    uint8_t flags;
+    uint8_t sync_ack;
+    uint8_t row_mask[ROW_MASK_BYTES];
+} split_status_frame_t;
+
+typedef struct {
+    uint8_t crc;
+    uint8_t seq;
+#ifdef ENCODER_ENABLE
+    uint8_t encoder_state[NUMBER_OF_ENCODERS];
+#endif
+    // only the rows set in the status row mask, in row order
+    matrix_row_t rows[ROWS_PER_HAND];
+} split_data_frame_t;
+
+typedef struct {
+    uint8_t crc;
+    uint8_t version;
+    uint8_t id;  // changes with every write, so a repeated request is seen again
+    uint8_t ack_seq;
+    uint8_t flags;
+} split_ack_frame_t;
+
+typedef struct {
+    uint8_t crc;
+    uint8_t version;
+    uint8_t seq;
+    uint8_t dirty;
+#ifdef BACKLIGHT_ENABLE
+    uint8_t backlight_level;
+#endif
+#ifdef WPM_ENABLE
+    uint8_t current_wpm;
+#endif
+#if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
+    rgblight_syncinfo_t rgblight_sync;
+#endif
+} split_sync_frame_t;
+
+typedef struct {
+    split_status_frame_t status;
+    split_data_frame_t   data;
+    split_ack_frame_t    ack;
+    split_sync_frame_t   sync;
+} split_registers_t;
+
+enum split_register {
+    SPLIT_REG_STATUS,
+    SPLIT_REG_DATA,
+    SPLIT_REG_ACK,
+    SPLIT_REG_SYNC,
+};
+
+static split_transport_stats_t stats;
+
+static uint8_t crc8(const uint8_t *data, uint8_t size) {
+    uint8_t crc = 0xFF;
+    while (size--) {
+        crc ^= *data++;
+        for (uint8_t i = 0; i < 8; i++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+/* The CRC covers the whole frame after the CRC byte */
+static inline void frame_seal(void *frame, uint8_t size) { ((uint8_t *)frame)[0] = crc8((uint8_t *)frame + 1, size - 1); }
+static inline bool frame_valid(const void *frame, uint8_t size) { return ((const uint8_t *)frame)[0] == crc8((const uint8_t *)frame + 1, size - 1); }
+
+static inline bool row_in_mask(const uint8_t *mask, uint8_t row) { return mask[row / 8] & (1 << (row % 8)); }
+
+static uint8_t data_frame_size(const split_status_frame_t *status) {
+    uint8_t rows = 0;
+    for (uint8_t i = 0; i < ROWS_PER_HAND; i++) {
+        rows += row_in_mask(status->row_mask, i);
+    }
+    return offsetof(split_data_frame_t, rows) + rows * sizeof(matrix_row_t);
+}
+
+// ---------------------------------------------------------------------------
+// Physical link: the master reads and writes slave registers
+
+#if defined(SPLIT_TRANSPORT_LOOPBACK)
+
+// Master and slave live in the same image, for host tests
+static split_registers_t registers;
+#    define split_registers (&registers)
+
+static uint8_t loopback_errors[4];
+
+void split_transport_loopback_inject_errors(uint8_t reg, uint8_t count) { loopback_errors[reg] = count; }
+
+static bool link_read(uint8_t reg, uint8_t offset, void *data, uint8_t size) {
+    memcpy(data, (uint8_t *)split_registers + offset, size);
+    if (loopback_errors[reg]) {
+        loopback_errors[reg]--;
+        ((uint8_t *)data)[size - 1] ^= 0x5A;
+    }
+    return true;
+}
+
+static bool link_write(uint8_t reg, uint8_t offset, const void *data, uint8_t size) {
+    memcpy((uint8_t *)split_registers + offset, data, size);
+    if (loopback_errors[reg]) {
+        loopback_errors[reg]--;
+        ((uint8_t *)split_registers + offset)[size - 1] ^= 0x5A;
+    }
+    return true;
+}
+
+#elif defined(USE_I2C)
+
+#    include "i2c_master.h"
+#    include "i2c_slave.h"
+
+_Static_assert(sizeof(split_registers_t) <= I2C_SLAVE_REG_COUNT, "Split registers don't fit in I2C_SLAVE_REG_COUNT");
+
+static split_registers_t *const split_registers = (split_registers_t *)i2c_slave_reg;
+
+#    ifndef SPLIT_I2C_TIMEOUT
+#        define SPLIT_I2C_TIMEOUT 100
+#    endif
+
+#    ifndef SLAVE_I2C_ADDRESS
+#        define SLAVE_I2C_ADDRESS 0x32
+#    endif
+
+static bool link_read(uint8_t reg, uint8_t offset, void *data, uint8_t size) { return i2c_readReg(SLAVE_I2C_ADDRESS, offset, data, size, SPLIT_I2C_TIMEOUT) >= 0; }
+
+static bool link_write(uint8_t reg, uint8_t offset, const void *data, uint8_t size) { return i2c_writeReg(SLAVE_I2C_ADDRESS, offset, data, size, SPLIT_I2C_TIMEOUT) >= 0; }
+
+void transport_master_init(void) { i2c_init(); }
+
+void transport_slave_init(void) { i2c_slave_init(SLAVE_I2C_ADDRESS); }
+
+#else  // USE_SERIAL
+
+#    include "serial.h"
+
+#    ifndef SERIAL_USE_MULTI_TRANSACTION
+#        error "The delta split transport needs SERIAL_USE_MULTI_TRANSACTION"
+#    endif
+
+static split_registers_t registers;
+#    define split_registers (&registers)
+
+static uint8_t volatile transaction_status[4];
+
+// One transaction per register, both halves use the same table
+static SSTD_t transactions[] = {
+    [SPLIT_REG_STATUS] = {(uint8_t *)&transaction_status[SPLIT_REG_STATUS], 0, NULL, sizeof(registers.status), (uint8_t *)&registers.status},
+    [SPLIT_REG_DATA]   = {(uint8_t *)&transaction_status[SPLIT_REG_DATA], 0, NULL, sizeof(registers.data), (uint8_t *)&registers.data},
+    [SPLIT_REG_ACK]    = {(uint8_t *)&transaction_status[SPLIT_REG_ACK], sizeof(registers.ack), (uint8_t *)&registers.ack, 0, NULL},
+    [SPLIT_REG_SYNC]   = {(uint8_t *)&transaction_status[SPLIT_REG_SYNC], sizeof(registers.sync), (uint8_t *)&registers.sync, 0, NULL},
+};
+
+static bool link_read(uint8_t reg, uint8_t offset, void *data, uint8_t size) {
+    if (soft_serial_transaction(reg) != TRANSACTION_END) {
+        return false;
+    }
+    memcpy(data, (uint8_t *)split_registers + offset, size);
+    return true;
+}
+
+static bool link_write(uint8_t reg, uint8_t offset, const void *data, uint8_t size) {
+    memcpy((uint8_t *)split_registers + offset, data, size);
+    return soft_serial_transaction(reg) == TRANSACTION_END;
+}
+
+void transport_master_init(void) { soft_serial_initiator_init(transactions, TID_LIMIT(transactions)); }
+
+void transport_slave_init(void) { soft_serial_target_init(transactions, TID_LIMIT(transactions)); }
+
+#endif
+
+const split_transport_stats_t *split_transport_get_stats(void) { return &stats; }
+
+void split_transport_clear_stats(void) { memset(&stats, 0, sizeof(stats)); }
+
+// ---------------------------------------------------------------------------
+// Master
+
+static matrix_row_t master_rows[ROWS_PER_HAND];
+static uint8_t      master_seq    = 0;
+static bool         master_valid  = false;
+static uint8_t      master_ack_id = 0;
+
+static split_sync_frame_t master_sync;
+static bool               master_sync_pending = false;
+
+static bool master_read(uint8_t reg, uint8_t offset, void *frame, uint8_t size) {
+    for (uint8_t attempt = 0; attempt <= SPLIT_TRANSPORT_RETRIES; attempt++) {
+        if (attempt) {
+            stats.retries++;
+        }
+        stats.transfers++;
+        stats.bytes += size;
+        if (link_read(reg, offset, frame, size)) {
+            if (frame_valid(frame, size)) {
+                return true;
+            }
+            stats.crc_errors++;
+        }
+    }
+    return false;
+}
+
+static bool master_write(uint8_t reg, uint8_t offset, void *frame, uint8_t size) {
+    frame_seal(frame, size);
+    for (uint8_t attempt = 0; attempt <= SPLIT_TRANSPORT_RETRIES; attempt++) {
+        if (attempt) {
+            stats.retries++;
+        }
+        stats.transfers++;
+        stats.bytes += size;
+        if (link_write(reg, offset, frame, size)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void master_write_ack(uint8_t flags) {
+    split_ack_frame_t ack = {
+        .version = SPLIT_PROTOCOL_VERSION,
+        .id      = ++master_ack_id,
+        .ack_seq = master_seq,
+        .flags   = flags,
+    };
+    master_write(SPLIT_REG_ACK, offsetof(split_registers_t, ack), &ack, sizeof(ack));
+}
+
+/* Queues a new sync packet when any of the synced fields changed */
+static void master_update_sync(void) {
+    uint8_t dirty = 0;
+#ifdef BACKLIGHT_ENABLE
+    uint8_t level = is_backlight_enabled() ? get_backlight_level() : 0;
+    if (level != master_sync.backlight_level) {
+        master_sync.backlight_level = level;
+        dirty |= SPLIT_SYNC_BACKLIGHT;
+    }
+#endif
+#ifdef WPM_ENABLE
+    uint8_t current_wpm = get_current_wpm();
+    if (current_wpm != master_sync.current_wpm) {
+        master_sync.current_wpm = current_wpm;
+        dirty |= SPLIT_SYNC_WPM;
+    }
+#endif
+#if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
+    if (rgblight_get_change_flags()) {
+        rgblight_get_syncinfo(&master_sync.rgblight_sync);
+        rgblight_clear_change_flags();
+        dirty |= SPLIT_SYNC_RGBLIGHT;
+    }
+#endif
+    if (dirty) {
+        // Fields still waiting for the slave stay dirty
+        master_sync.dirty   = (master_sync_pending ? master_sync.dirty : 0) | dirty;
+        master_sync.version = SPLIT_PROTOCOL_VERSION;
+        master_sync.seq++;
+        master_sync_pending = true;
+    }
+}
+
+static bool master_transfer(void) {
+    master_update_sync();
+    if (master_sync_pending) {
+        split_sync_frame_t frame = master_sync;
+        master_write(SPLIT_REG_SYNC, offsetof(split_registers_t, sync), &frame, sizeof(frame));
+    }
+
+    split_status_frame_t status;
+    split_data_frame_t   data;
+    for (uint8_t attempt = 0; attempt <= SPLIT_TRANSPORT_RETRIES; attempt++) {
+        if (!master_read(SPLIT_REG_STATUS, offsetof(split_registers_t, status), &status, sizeof(status))) {
+            return false;
+        }
+        if (status.version != SPLIT_PROTOCOL_VERSION) {
+            return false;
+        }
+        if (master_sync_pending && status.sync_ack == master_sync.seq) {
+            master_sync_pending = false;
+        }
+
+        bool same_session = status.flags & SPLIT_STATUS_SESSION;
+        if (master_valid && same_session && status.seq == master_seq) {
+            // Nothing changed
+            return true;
+        }
+        if (!(status.flags & SPLIT_STATUS_FULL) && (!master_valid || !same_session || status.base_seq != master_seq)) {
+            // The rows are relative to a state we don't have
+            master_write_ack(SPLIT_ACK_REQUEST_FULL);
+            return master_valid;
+        }
+
+        uint8_t size = data_frame_size(&status);
+        if (!master_read(SPLIT_REG_DATA, offsetof(split_registers_t, data), &data, size)) {
+            return false;
+        }
+        if (data.seq != status.seq) {
+            // The slave published a new state between the two reads
+            stats.retries++;
+            continue;
+        }
+
+        for (uint8_t i = 0, n = 0; i < ROWS_PER_HAND; i++) {
+            if (row_in_mask(status.row_mask, i)) {
+                master_rows[i] = data.rows[n++];
+            }
+        }
+#ifdef ENCODER_ENABLE
+        encoder_update_raw(data.encoder_state);
+#endif
+        if (status.flags & SPLIT_STATUS_FULL) {
+            stats.full_frames++;
+        }
+        master_seq   = status.seq;
+        master_valid = true;
+        master_write_ack(0);
+        return true;
+    }
+    return false;
+}
+
+bool transport_master(matrix_row_t matrix[]) {
+    if (!master_transfer()) {
+        // The slave may have reset, don't trust the rows we have
+        master_valid = false;
+        return false;
+    }
+    memcpy(matrix, master_rows, sizeof(master_rows));
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Slave
+
+static matrix_row_t slave_history[SPLIT_TRANSPORT_HISTORY][ROWS_PER_HAND];
+static uint8_t      slave_history_seq[SPLIT_TRANSPORT_HISTORY];
+static matrix_row_t slave_confirmed[ROWS_PER_HAND];
+static uint8_t      slave_seq             = 0;
+static uint8_t      slave_confirmed_seq   = 0;
+static bool         slave_confirmed_valid = false;
+static bool         slave_published_valid = false;
+static bool         slave_send_full       = false;
+static bool         slave_session         = false;
+static uint8_t      slave_ack_id          = 0;
+static uint8_t      slave_sync_seq        = 0;
+
+#define SLAVE_PUBLISHED(seq) slave_history[(seq) % SPLIT_TRANSPORT_HISTORY]
+#ifdef ENCODER_ENABLE
+static uint8_t slave_encoder_state[NUMBER_OF_ENCODERS];
+#endif
+
+static void slave_receive(void) {
+    split_ack_frame_t ack = split_registers->ack;
+    if (frame_valid(&ack, sizeof(ack)) && ack.version == SPLIT_PROTOCOL_VERSION && ack.id != slave_ack_id) {
+        slave_ack_id  = ack.id;
+        slave_session = true;
+        if (ack.flags & SPLIT_ACK_REQUEST_FULL) {
+            slave_send_full = true;
+        } else if (slave_published_valid && slave_history_seq[ack.ack_seq % SPLIT_TRANSPORT_HISTORY] == ack.ack_seq) {
+            memcpy(slave_confirmed, SLAVE_PUBLISHED(ack.ack_seq), sizeof(slave_confirmed));
+            slave_confirmed_seq   = ack.ack_seq;
+            slave_confirmed_valid = true;
+        }
+    }
+
+    split_sync_frame_t sync = split_registers->sync;
+    if (frame_valid(&sync, sizeof(sync)) && sync.version == SPLIT_PROTOCOL_VERSION && sync.seq != slave_sync_seq) {
+#ifdef BACKLIGHT_ENABLE
+        if (sync.dirty & SPLIT_SYNC_BACKLIGHT) {
+            backlight_set(sync.backlight_level);
+        }
+#endif
+#ifdef WPM_ENABLE
+        if (sync.dirty & SPLIT_SYNC_WPM) {
+            set_current_wpm(sync.current_wpm);
+        }
+#endif
+#if defined(RGBLIGHT_ENABLE) && defined(RGBLIGHT_SPLIT)
+        if (sync.dirty & SPLIT_SYNC_RGBLIGHT) {
+            rgblight_update_sync(&sync.rgblight_sync, false);
+        }
+#endif
+        slave_sync_seq = sync.seq;
+    }
+}
+
+static void slave_publish(matrix_row_t matrix[]) {
+    split_status_frame_t status = {
+        .version  = SPLIT_PROTOCOL_VERSION,
+        .sync_ack = slave_sync_seq,
+    };
+    split_data_frame_t data    = {0};
+    uint8_t            session = slave_session ? SPLIT_STATUS_SESSION : 0;
+
+    bool changed = !slave_published_valid || slave_send_full || memcmp(matrix, SLAVE_PUBLISHED(slave_seq), sizeof(slave_confirmed)) != 0;
+#ifdef ENCODER_ENABLE
+    encoder_state_raw(data.encoder_state);
+    changed |= memcmp(data.encoder_state, slave_encoder_state, sizeof(slave_encoder_state)) != 0;
+    memcpy(slave_encoder_state, data.encoder_state, sizeof(slave_encoder_state));
+#endif
+
+    if (changed) {
+        bool full = slave_send_full || !slave_confirmed_valid;
+        slave_seq++;
+        memcpy(SLAVE_PUBLISHED(slave_seq), matrix, sizeof(slave_confirmed));
+        slave_history_seq[slave_seq % SPLIT_TRANSPORT_HISTORY] = slave_seq;
+        slave_published_valid                                  = true;
+        slave_send_full       = false;
+
+        status.seq      = slave_seq;
+        status.base_seq = slave_confirmed_seq;
+        status.flags    = (full ? SPLIT_STATUS_FULL : 0) | session;
+        data.seq        = slave_seq;
+        for (uint8_t i = 0, n = 0; i < ROWS_PER_HAND; i++) {
+            if (full || matrix[i] != slave_confirmed[i]) {
+                status.row_mask[i / 8] |= 1 << (i % 8);
+                data.rows[n++] = matrix[i];
+            }
+        }
+        frame_seal(&data, data_frame_size(&status));
+        split_registers->data = data;
+    } else {
+        status.seq      = slave_seq;
+        status.base_seq = split_registers->status.base_seq;
+        status.flags    = (split_registers->status.flags & SPLIT_STATUS_FULL) | session;
+        memcpy(status.row_mask, split_registers->status.row_mask, sizeof(status.row_mask));
+    }
+
+    frame_seal(&status, sizeof(status));
+    if (memcmp(&status, &split_registers->status, sizeof(status)) != 0) {
+        split_registers->status = status;
+    }
+}
+
+void transport_slave(matrix_row_t matrix[]) {
+    slave_receive();
+    slave_publish(matrix);
+}
+
+#ifdef SPLIT_TRANSPORT_LOOPBACK
+void transport_master_init(void) {
+    memset(&registers, 0, sizeof(registers));
+    memset(loopback_errors, 0, sizeof(loopback_errors));
+    memset(master_rows, 0, sizeof(master_rows));
+    memset(&master_sync, 0, sizeof(master_sync));
+    master_seq          = 0;
+    master_valid        = false;
+    master_ack_id       = 0;
+    master_sync_pending = false;
+    split_transport_clear_stats();
+}
+
+void transport_slave_init(void) {
+    // A slave that resets starts with cleared registers
+    memset(&registers, 0, sizeof(registers));
+    memset(slave_history, 0, sizeof(slave_history));
+    memset(slave_history_seq, 0, sizeof(slave_history_seq));
+    slave_seq             = 0;
+    slave_confirmed_seq   = 0;
+    slave_confirmed_valid = false;
+    slave_published_valid = false;
+    slave_send_full       = false;
+    slave_session         = false;
+    slave_ack_id          = 0;
+    slave_sync_seq        = 0;
+}
+#endif
@@ -0,0 +1,219 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <functional>
+
+extern "C" {
+#include "quantum.h"
+#include "matrix.h"
+#include "timer.h"
+
+void advance_time(uint32_t ms);
+void set_time(uint32_t t);
+}
+
+#define PINS (MATRIX_ROWS + MATRIX_COLS)
+#define ROW_PIN(row) (row)
+#define COL_PIN(col) (MATRIX_ROWS + (col))
+
+// Simulated GPIO: a column reads low when a pressed key connects it to a row driven low
+static bool                  output[PINS];
+static bool                  output_high[PINS];
+static bool                  wake_enabled[PINS];
+static bool                  wake_unsupported[PINS];
+static bool                  level[PINS];
+static bool                  pressed[MATRIX_ROWS][MATRIX_COLS];
+static int                   reads;
+static int                   sleeps;
+static std::function<void()> on_wake_enable;
+
+static bool pin_level(pin_t pin) {
+    if (output[pin]) {
+        return output_high[pin];
+    }
+    if (pin >= MATRIX_ROWS) {
+        uint8_t col = pin - MATRIX_ROWS;
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            if (pressed[row][col] && output[ROW_PIN(row)] && !output_high[ROW_PIN(row)]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Fires the pin change interrupt on falling edges of enabled pins
+static void update_levels(void) {
+    for (pin_t pin = 0; pin < PINS; pin++) {
+        bool now = pin_level(pin);
+        if (level[pin] && !now && wake_enabled[pin]) {
+            matrix_wake();
+        }
+        level[pin] = now;
+    }
+}
+
+static void press(uint8_t row, uint8_t col, bool state) {
+    pressed[row][col] = state;
+    update_levels();
+}
+
+extern "C" {
+void setPinInput(pin_t pin) {
+    output[pin] = false;
+    update_levels();
+}
+void setPinInputHigh(pin_t pin) { setPinInput(pin); }
+void setPinOutput(pin_t pin) {
+    output[pin] = true;
+    update_levels();
+}
+void writePinHigh(pin_t pin) {
+    output_high[pin] = true;
+    update_levels();
+}
+void writePinLow(pin_t pin) {
+    output_high[pin] = false;
+    update_levels();
+}
+bool readPin(pin_t pin) {
+    reads++;
+    return pin_level(pin);
+}
+
+bool matrix_wake_pin_enable(pin_t pin) {
+    if (wake_unsupported[pin]) {
+        return false;
+    }
+    wake_enabled[pin] = true;
+    if (on_wake_enable) {
+        on_wake_enable();
+    }
+    return true;
+}
+void matrix_wake_pin_disable(pin_t pin) { wake_enabled[pin] = false; }
+
+void matrix_idle_sleep(void) { sleeps++; }
+
+matrix_row_t raw_matrix[MATRIX_ROWS];
+matrix_row_t matrix[MATRIX_ROWS];
+
+void matrix_io_delay(void) {}
+void matrix_init_quantum(void) {}
+void matrix_scan_quantum(void) {}
+}
+
+class MatrixInterruptScan : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        for (pin_t pin = 0; pin < PINS; pin++) {
+            output[pin]           = false;
+            output_high[pin]      = false;
+            wake_enabled[pin]     = false;
+            wake_unsupported[pin] = false;
+            level[pin]            = true;
+        }
+        memset(pressed, 0, sizeof(pressed));
+        on_wake_enable = nullptr;
+        set_time(0);
+        matrix_init();
+        reads  = 0;
+        sleeps = 0;
+    }
+
+    void scan_for(uint32_t ms) {
+        for (uint32_t i = 0; i < ms; i++) {
+            matrix_scan();
+            advance_time(1);
+        }
+    }
+
+    bool is_on(uint8_t row, uint8_t col) { return matrix[row] & (MATRIX_ROW_SHIFTER << col); }
+};
+
+TEST_F(MatrixInterruptScan, GoesIdleWhenNothingIsPressed) {
+    scan_for(MATRIX_IDLE_TIMEOUT);
+    EXPECT_FALSE(matrix_is_idle());
+    scan_for(1);
+    EXPECT_TRUE(matrix_is_idle());
+
+    // All rows are driven and every column can wake the matrix
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        EXPECT_TRUE(output[ROW_PIN(row)] && !output_high[ROW_PIN(row)]);
+    }
+    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+        EXPECT_TRUE(wake_enabled[COL_PIN(col)]);
+    }
+
+    reads  = 0;
+    sleeps = 0;
+    scan_for(100);
+    EXPECT_EQ(reads, 0);
+    EXPECT_EQ(sleeps, 100);
+}
+
+TEST_F(MatrixInterruptScan, PressWakesTheMatrix) {
+    scan_for(MATRIX_IDLE_TIMEOUT + 1);
+    ASSERT_TRUE(matrix_is_idle());
+
+    press(2, 1, true);
+    scan_for(1);
+    EXPECT_FALSE(matrix_is_idle());
+    for (pin_t pin = 0; pin < PINS; pin++) {
+        EXPECT_FALSE(wake_enabled[pin]);
+    }
+    scan_for(DEBOUNCE + 1);
+    EXPECT_TRUE(is_on(2, 1));
+}
+
+TEST_F(MatrixInterruptScan, PressWhileGoingIdleIsNotLost) {
+    // The key goes down after the last scan, before the interrupts are enabled
+    on_wake_enable = [] {
+        on_wake_enable = nullptr;
+        pressed[3][3]  = true;
+    };
+    scan_for(MATRIX_IDLE_TIMEOUT + 1);
+    ASSERT_TRUE(matrix_is_idle());
+
+    scan_for(DEBOUNCE + 2);
+    EXPECT_FALSE(matrix_is_idle());
+    EXPECT_TRUE(is_on(3, 3));
+}
+
+TEST_F(MatrixInterruptScan, StaysAwakeWhileAKeyIsHeld) {
+    press(0, 0, true);
+    scan_for(500);
+    EXPECT_FALSE(matrix_is_idle());
+    EXPECT_TRUE(is_on(0, 0));
+
+    press(0, 0, false);
+    scan_for(DEBOUNCE + MATRIX_IDLE_TIMEOUT);
+    EXPECT_FALSE(matrix_is_idle());
+    EXPECT_FALSE(is_on(0, 0));
+    scan_for(DEBOUNCE + 1);
+    EXPECT_TRUE(matrix_is_idle());
+}
+
+TEST_F(MatrixInterruptScan, PinsThatCannotWakeKeepPolling) {
+    wake_unsupported[COL_PIN(2)] = true;
+    scan_for(MATRIX_IDLE_TIMEOUT * 4);
+    EXPECT_FALSE(matrix_is_idle());
+    for (pin_t pin = 0; pin < PINS; pin++) {
+        EXPECT_FALSE(wake_enabled[pin]);
+    }
+    EXPECT_FALSE(output[ROW_PIN(0)]);
+}
@@ -0,0 +1,159 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+
+extern "C" {
+#include "quantum.h"
+#include "matrix.h"
+
+void advance_time(uint32_t ms);
+}
+
+#define PORTS 16
+
+#ifdef DIRECT_PINS
+static const pin_t key_pins[MATRIX_ROWS][MATRIX_COLS] = DIRECT_PINS;
+#else
+static const pin_t row_pins[MATRIX_ROWS] = MATRIX_ROW_PINS;
+static const pin_t col_pins[MATRIX_COLS] = MATRIX_COL_PINS;
+#endif
+
+// Simulated GPIO ports: an input reads low when a pressed key connects it to ground or a selected row
+static bool pressed[MATRIX_ROWS][MATRIX_COLS];
+static bool output[PORTS * 16];
+static bool output_high[PORTS * 16];
+static int  pin_reads;
+static int  port_reads;
+
+static bool pin_level(pin_t pin) {
+    if (output[pin]) {
+        return output_high[pin];
+    }
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+#ifdef DIRECT_PINS
+            if (pressed[row][col] && key_pins[row][col] == pin) {
+                return false;
+            }
+#else
+            if (pressed[row][col] && col_pins[col] == pin && output[row_pins[row]] && !output_high[row_pins[row]]) {
+                return false;
+            }
+#endif
+        }
+    }
+    return true;
+}
+
+extern "C" {
+void setPinInput(pin_t pin) { output[pin] = false; }
+void setPinInputHigh(pin_t pin) { output[pin] = false; }
+void setPinOutput(pin_t pin) { output[pin] = true; }
+void writePinHigh(pin_t pin) { output_high[pin] = true; }
+void writePinLow(pin_t pin) { output_high[pin] = false; }
+
+bool readPin(pin_t pin) {
+    pin_reads++;
+    return pin_level(pin);
+}
+
+port_data_t readPinPort(pin_t pin) {
+    port_data_t data = 0;
+    for (uint8_t bit = 0; bit < 16; bit++) {
+        data |= (port_data_t)pin_level((getPinPort(pin) << 4) | bit) << bit;
+    }
+    port_reads++;
+    return data;
+}
+
+matrix_row_t raw_matrix[MATRIX_ROWS];
+matrix_row_t matrix[MATRIX_ROWS];
+
+void matrix_io_delay(void) {}
+void matrix_init_quantum(void) {}
+void matrix_scan_quantum(void) {}
+}
+
+class MatrixPortReads : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        memset(pressed, 0, sizeof(pressed));
+        matrix_init();
+    }
+
+    void scan() {
+        for (uint8_t i = 0; i <= DEBOUNCE + 1; i++) {
+            matrix_scan();
+            advance_time(1);
+        }
+    }
+
+    void expect_pressed() {
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            matrix_row_t expected = 0;
+            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                expected |= (matrix_row_t)pressed[row][col] << col;
+            }
+            EXPECT_EQ(matrix[row], expected) << "row " << (int)row;
+        }
+    }
+
+    bool wired(uint8_t row, uint8_t col) {
+#ifdef DIRECT_PINS
+        return key_pins[row][col] != NO_PIN;
+#else
+        return true;
+#endif
+    }
+};
+
+TEST_F(MatrixPortReads, EachKeyLandsInItsColumn) {
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            if (!wired(row, col)) {
+                continue;
+            }
+            pressed[row][col] = true;
+            scan();
+            expect_pressed();
+            pressed[row][col] = false;
+        }
+    }
+}
+
+TEST_F(MatrixPortReads, ManyKeysAtOnce) {
+    uint32_t seed = 1;
+    for (int i = 0; i < 50; i++) {
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                seed              = seed * 1103515245 + 12345;
+                pressed[row][col] = wired(row, col) && (seed >> 16) % 3 == 0;
+            }
+        }
+        scan();
+        expect_pressed();
+    }
+}
+
+TEST_F(MatrixPortReads, EachPortIsReadOncePerRow) {
+    pin_reads  = 0;
+    port_reads = 0;
+    matrix_scan();
+    EXPECT_EQ(pin_reads, 0);
+    // Reading pin by pin took MATRIX_ROWS * MATRIX_COLS reads per scan
+    EXPECT_EQ(port_reads, PORTS_PER_SCAN);
+}
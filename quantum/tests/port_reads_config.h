@@ -0,0 +1,40 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#define MATRIX_COLS 20
+
+// Pin 0xPB is bit B of port P. The columns are spread over three ports:
+// in order, reversed, shifted, and one more bit on the first port.
+#define PORT_READS_ROW0 \
+    { 0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x27, 0x26, 0x25, 0x24, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x1F }
+
+#ifdef PORT_READS_DIRECT
+#    define MATRIX_ROWS 2
+#    define DIRECT_PINS \
+        { PORT_READS_ROW0, { 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F, NO_PIN, NO_PIN, NO_PIN, 0x20 } }
+#    define PORTS_PER_SCAN 4
+#else
+#    define MATRIX_ROWS 4
+#    define MATRIX_ROW_PINS \
+        { 0x00, 0x01, 0x02, 0x03 }
+#    define MATRIX_COL_PINS PORT_READS_ROW0
+#    define DIODE_DIRECTION COL2ROW
+#    define PORTS_PER_SCAN (3 * MATRIX_ROWS)
+#endif
+
+#define DEBOUNCE 5
@@ -0,0 +1,41 @@
+matrix_interrupt_scan_DEFS := \
+	-DMATRIX_INTERRUPT_SCAN \
+	-DIGNORE_ATOMIC_BLOCK
+
+matrix_interrupt_scan_INC := \
+	$(QUANTUM_PATH)/tests \
+	$(TMK_PATH)/common
+
+matrix_interrupt_scan_SRC := \
+	$(QUANTUM_PATH)/tests/matrix_interrupt_scan_tests.cpp \
+	$(QUANTUM_PATH)/matrix.c \
+	$(QUANTUM_PATH)/debounce/sym_defer_g.c \
+	$(TMK_PATH)/common/test/timer.c
+
+matrix_interrupt_scan_CONFIG := \
+	$(QUANTUM_PATH)/tests/interrupt_scan_config.h
+
+matrix_port_reads_DEFS := \
+	-DMATRIX_PORT_READS \
+	-DIGNORE_ATOMIC_BLOCK
+
+matrix_port_reads_CONFIG := \
+	$(QUANTUM_PATH)/tests/port_reads_config.h
+
+matrix_port_reads_INC := \
+	$(QUANTUM_PATH)/tests \
+	$(TMK_PATH)/common
+
+matrix_port_reads_SRC := \
+	$(QUANTUM_PATH)/tests/matrix_port_reads_tests.cpp \
+	$(QUANTUM_PATH)/matrix.c \
+	$(QUANTUM_PATH)/debounce/sym_defer_g.c \
+	$(TMK_PATH)/common/test/timer.c
+
+matrix_port_reads_direct_DEFS := \
+	$(matrix_port_reads_DEFS) \
+	-DPORT_READS_DIRECT
+
+matrix_port_reads_direct_CONFIG := $(matrix_port_reads_CONFIG)
+matrix_port_reads_direct_INC := $(matrix_port_reads_INC)
+matrix_port_reads_direct_SRC := $(matrix_port_reads_SRC)
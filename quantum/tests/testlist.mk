@@ -0,0 +1,3 @@
+TEST_LIST += matrix_interrupt_scan
+TEST_LIST += matrix_port_reads
+TEST_LIST += matrix_port_reads_direct
@@ -25,8 +25,6 @@ static uint16_t wpm_timer   = 0;
 // This smoothing is 40 keystrokes
 static const float wpm_smoothing = 0.0487;
 
-void set_current_wpm(uint8_t new_wpm) { current_wpm = new_wpm; }
-
 uint8_t get_current_wpm(void) { return current_wpm; }
 
 bool wpm_keycode(uint16_t keycode) { return wpm_keycode_kb(keycode); }
@@ -46,6 +44,27 @@ __attribute__((weak)) bool wpm_keycode_user(uint16_t keycode) {
     return false;
 }
 
+// Decays once a second while nothing is typed, until it reaches zero
+static deferred_token wpm_decay_token = INVALID_DEFERRED_TOKEN;
+
+static uint32_t wpm_decay(uint32_t trigger_time, void *cb_arg) {
+    current_wpm = (0 - current_wpm) * wpm_smoothing + current_wpm;
+    wpm_timer   = timer_read();
+    if (!current_wpm) {
+        wpm_decay_token = INVALID_DEFERRED_TOKEN;
+        return 0;
+    }
+    return 1000;
+}
+
+// Split slaves get this on every scan, an already running decay carries on
+void set_current_wpm(uint8_t new_wpm) {
+    current_wpm = new_wpm;
+    if (current_wpm && wpm_decay_token == INVALID_DEFERRED_TOKEN) {
+        wpm_decay_token = defer_exec(1000, wpm_decay, NULL);
+    }
+}
+
 void update_wpm(uint16_t keycode) {
     if (wpm_keycode(keycode)) {
         if (wpm_timer > 0) {
@@ -53,12 +72,8 @@ void update_wpm(uint16_t keycode) {
             current_wpm = (latest_wpm - current_wpm) * wpm_smoothing + current_wpm;
         }
         wpm_timer = timer_read();
-    }
-}
-
-void decay_wpm(void) {
-    if (timer_elapsed(wpm_timer) > 1000) {
-        current_wpm = (0 - current_wpm) * wpm_smoothing + current_wpm;
-        wpm_timer   = timer_read();
+        if (!extend_deferred_exec(wpm_decay_token, 1000)) {
+            wpm_decay_token = defer_exec(1000, wpm_decay, NULL);
+        }
     }
 }
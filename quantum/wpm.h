@@ -26,5 +26,3 @@ bool wpm_keycode_user(uint16_t keycode);
 void    set_current_wpm(uint8_t);
 uint8_t get_current_wpm(void);
 void    update_wpm(uint16_t);
-
-void decay_wpm(void);
@@ -16,9 +16,11 @@
 
 #include "test_common.hpp"
 #include "action_tapping.h"
+#include <vector>
 
 using testing::_;
 using testing::InSequence;
+using testing::Invoke;
 
 class Tapping : public TestFixture {};
 
@@ -95,3 +97,61 @@ TEST_F(Tapping, ANewTapWithinTappingTermIsBuggy) {
     EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT))).Times(1);
     idle_for(TAPPING_TERM);
 }
+
+// Rolling at 150 WPM, keys overlap by about 15ms
+TEST_F(Tapping, FastRollUnderA_SHFT_T_KeyFillsTheBufferAndHolds) {
+    TestDriver                     driver;
+    std::vector<report_keyboard_t> reports;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).WillRepeatedly(Invoke([&](report_keyboard_t &report) { reports.push_back(report); }));
+
+    // Each key goes down 15ms after the previous one, which is let go at the same time
+    const uint8_t keys[][2] = {{0, 0}, {1, 0}, {0, 3}, {1, 3}, {0, 0}, {1, 0}, {0, 3}, {1, 3}};
+    const uint8_t codes[]   = {KC_A, KC_B, KC_C, KC_D, KC_A, KC_B, KC_C, KC_D};
+    const int     count     = sizeof(codes);
+    static_assert(count * 2 > WAITING_BUFFER_SIZE, "the roll has to overflow the buffer");
+
+    press_key(7, 0);
+    idle_for(15);
+    for (int i = 0; i < count; i++) {
+        press_key(keys[i][0], keys[i][1]);
+        if (i > 0) {
+            release_key(keys[i - 1][0], keys[i - 1][1]);
+        }
+        idle_for(15);
+    }
+    release_key(keys[count - 1][0], keys[count - 1][1]);
+    idle_for(15);
+    release_key(7, 0);
+    idle_for(15);
+
+    // Every key comes through, in order and shifted
+    std::vector<uint8_t> pressed;
+    report_keyboard_t    last = {};
+    for (auto &report : reports) {
+        for (int k = 0; k < KEYBOARD_REPORT_KEYS; k++) {
+            uint8_t code = report.keys[k];
+            if (code == KC_NO) continue;
+            bool was_down = false;
+            for (int j = 0; j < KEYBOARD_REPORT_KEYS; j++) {
+                was_down |= last.keys[j] == code;
+            }
+            if (!was_down) {
+                EXPECT_EQ(report.mods, MOD_BIT(KC_LSFT));
+                pressed.push_back(code);
+            }
+        }
+        last = report;
+    }
+    EXPECT_EQ(pressed, std::vector<uint8_t>(codes, codes + count));
+    EXPECT_EQ(reports.back(), report_keyboard_t{});
+
+    // Tapping still works afterwards
+    testing::Mock::VerifyAndClearExpectations(&driver);
+    InSequence s;
+    press_key(7, 0);
+    run_one_scan_loop();
+    release_key(7, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_P)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    idle_for(10);
+}
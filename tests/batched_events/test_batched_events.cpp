@@ -0,0 +1,111 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include <chrono>
+#include <iostream>
+
+using testing::_;
+using testing::AnyNumber;
+using testing::InSequence;
+using testing::Invoke;
+
+namespace {
+struct ChordResult {
+    unsigned scans;
+    unsigned reports;
+    double   nanoseconds;
+};
+}  // namespace
+
+class BatchedEvents : public TestFixture {
+   protected:
+    // Press the first n keys of row 0 at once and run scans until every one of them is reported
+    ChordResult press_chord(TestDriver& driver, uint8_t n) {
+        report_keyboard_t last     = {};
+        unsigned          reports  = 0;
+        unsigned          scans    = 0;
+        uint8_t           expected = 0;
+        EXPECT_CALL(driver, send_keyboard_mock(_)).WillRepeatedly(Invoke([&](report_keyboard_t& report) {
+            last = report;
+            reports++;
+        }));
+        for (uint8_t c = 0; c < n; c++) {
+            press_key(c, 0);
+        }
+        auto start = std::chrono::steady_clock::now();
+        while (expected < n && scans < 100) {
+            keyboard_task();
+            scans++;
+            expected = __builtin_popcount(last.mods);
+            for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+                if (last.keys[i]) expected++;
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+        testing::Mock::VerifyAndClearExpectations(&driver);
+        return {scans, reports, std::chrono::duration<double, std::nano>(end - start).count()};
+    }
+
+    void benchmark_chord(uint8_t n) {
+        TestDriver  driver;
+        ChordResult result = press_chord(driver, n);
+        std::cout << (unsigned)n << "-key chord: " << result.scans << " scan(s), " << result.reports << " report(s), " << result.nanoseconds << " ns scan-to-report" << std::endl;
+        EXPECT_EQ(result.scans, 1u);
+        EXPECT_EQ(result.reports, 1u);
+
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+        clear_all_keys();
+        keyboard_task();
+    }
+};
+
+TEST_F(BatchedEvents, TwoKeyChordIsReportedInOneScan) { benchmark_chord(2); }
+
+TEST_F(BatchedEvents, FourKeyChordIsReportedInOneScan) { benchmark_chord(4); }
+
+TEST_F(BatchedEvents, TenKeyChordIsReportedInOneScan) { benchmark_chord(10); }
+
+TEST_F(BatchedEvents, KeysInDifferentRowsAreReportedTogether) {
+    TestDriver driver;
+    press_key(1, 0);
+    press_key(1, 1);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B, KC_G)));
+    keyboard_task();
+    release_key(1, 0);
+    release_key(1, 1);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    keyboard_task();
+}
+
+TEST_F(BatchedEvents, TapResolvedWithinBatchIsNotLost) {
+    TestDriver driver;
+    InSequence s;
+    press_key(0, 1);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    keyboard_task();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // Releasing the mod-tap and pressing another key in the same scan resolves the tap
+    release_key(0, 1);
+    press_key(1, 1);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_P)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_G)));
+    keyboard_task();
+    release_key(1, 1);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    keyboard_task();
+}
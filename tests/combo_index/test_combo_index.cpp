@@ -0,0 +1,172 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+using testing::_;
+using testing::AnyNumber;
+using testing::AtLeast;
+using testing::InSequence;
+
+#define MAX_BENCHMARK_COMBOS 1000
+
+extern "C" {
+combo_t key_combos[MAX_BENCHMARK_COMBOS];
+int     COMBO_LEN = 0;
+}
+
+namespace {
+const uint16_t ab_combo[] = {KC_A, KC_B, COMBO_END};
+const uint16_t de_combo[] = {KC_D, KC_E, COMBO_END};
+
+// Two keycodes per benchmark combo, none of them on the keyboard
+uint16_t benchmark_keys[MAX_BENCHMARK_COMBOS][3];
+}  // namespace
+
+class Combo : public TestFixture {
+   protected:
+    void SetUp() override { set_combos(0); }
+
+    // Install the A+B and D+E combos followed by n - 2 combos on keys that aren't in the keymap
+    void set_combos(int n) {
+        key_combos[0] = (combo_t)COMBO(ab_combo, KC_ESC);
+        key_combos[1] = (combo_t)COMBO(de_combo, KC_TAB);
+        for (int i = 2; i < n; i++) {
+            benchmark_keys[i][0] = 0x7000 + i;
+            benchmark_keys[i][1] = 0x7000 + i + 1;
+            benchmark_keys[i][2] = COMBO_END;
+            key_combos[i]        = (combo_t)COMBO_ACTION(benchmark_keys[i]);
+        }
+        COMBO_LEN = n < 2 ? 2 : n;
+#ifdef COMBO_KEY_INDEX
+        combo_key_index_reset();
+#endif
+    }
+
+    // Start each test with a key that isn't part of any combo
+    void arm_combos(TestDriver& driver) {
+        EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+        press_key(2, 0);
+        run_one_scan_loop();
+        release_key(2, 0);
+        run_one_scan_loop();
+        testing::Mock::VerifyAndClearExpectations(&driver);
+    }
+
+    void benchmark(int n) {
+        TestDriver driver;
+        set_combos(n);
+        arm_combos(driver);
+
+        // Time process_combo() alone, tapping a key that isn't in any combo and rolling over a
+        // combo whose keys are also part of its neighbours
+        keyrecord_t record    = {};
+        const int   rounds    = 10000;
+        auto        run_keys  = [&](std::vector<uint16_t> keycodes) {
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < rounds; i++) {
+                for (bool pressed : {true, false}) {
+                    record.event.pressed = pressed;
+                    for (uint16_t keycode : keycodes) {
+                        process_combo(keycode, &record);
+                    }
+                }
+            }
+            auto end = std::chrono::steady_clock::now();
+            return std::chrono::duration<double, std::nano>(end - start).count() / (rounds * 2 * keycodes.size());
+        };
+        double other_key = run_keys({KC_C});
+        double combo_key = run_keys({(uint16_t)(0x7000 + n / 2), (uint16_t)(0x7000 + n / 2 + 1)});
+#ifdef COMBO_KEY_INDEX
+        const char* variant = "indexed";
+#else
+        const char* variant = "linear";
+#endif
+        std::cout << n << " combos (" << variant << "): " << other_key << " ns per non-combo key event, " << combo_key << " ns per combo key event" << std::endl;
+
+        // The combos still work after the benchmark
+        EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_ESC))).Times(1);
+        tap_combo(0, 1);
+    }
+
+    // The matrix scan handles one key change per loop
+    void tap_combo(uint8_t col_a, uint8_t col_b) {
+        press_key(col_a, 0);
+        run_one_scan_loop();
+        press_key(col_b, 0);
+        run_one_scan_loop();
+        release_key(col_a, 0);
+        run_one_scan_loop();
+        release_key(col_b, 0);
+        run_one_scan_loop();
+    }
+};
+
+TEST_F(Combo, ComboKeysSendComboKeycode) {
+    TestDriver driver;
+    arm_combos(driver);
+    InSequence s;
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_ESC)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AtLeast(1));
+    tap_combo(0, 1);
+}
+
+TEST_F(Combo, SecondComboIsFound) {
+    TestDriver driver;
+    arm_combos(driver);
+    InSequence s;
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_TAB)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AtLeast(1));
+    tap_combo(3, 4);
+}
+
+TEST_F(Combo, OtherKeysArePassedThrough) {
+    TestDriver driver;
+    arm_combos(driver);
+    InSequence s;
+    press_key(5, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_F)));
+    run_one_scan_loop();
+    release_key(5, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
+
+TEST_F(Combo, ComboKeyAloneIsSentAfterComboTerm) {
+    TestDriver driver;
+    arm_combos(driver);
+    InSequence s;
+    press_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+    // Flushing the buffered key sends its report twice
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A))).Times(2);
+    idle_for(COMBO_TERM + 1);
+    release_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
+
+TEST_F(Combo, Benchmark50Combos) { benchmark(50); }
+
+TEST_F(Combo, Benchmark200Combos) { benchmark(200); }
+
+TEST_F(Combo, Benchmark1000Combos) { benchmark(1000); }
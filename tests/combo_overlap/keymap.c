@@ -0,0 +1,54 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "quantum.h"
+
+const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
+    [0] =
+        {
+            {KC_A, KC_B, KC_C, KC_D, KC_E, KC_F, KC_G, KC_H, KC_I, KC_J},
+            {KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+            {KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+            {KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+        },
+};
+
+enum combos { AB_ESC, ABC_TAB, BC_ENT, DE_SPC, GHIJ_DEL };
+
+const uint16_t PROGMEM ab_combo[]   = {KC_A, KC_B, COMBO_END};
+const uint16_t PROGMEM abc_combo[]  = {KC_A, KC_B, KC_C, COMBO_END};
+const uint16_t PROGMEM bc_combo[]   = {KC_B, KC_C, COMBO_END};
+const uint16_t PROGMEM de_combo[]   = {KC_D, KC_E, COMBO_END};
+const uint16_t PROGMEM ghij_combo[] = {KC_G, KC_H, KC_I, KC_J, COMBO_END};
+
+combo_t key_combos[COMBO_COUNT] = {
+    [AB_ESC]   = COMBO(ab_combo, KC_ESC),
+    [ABC_TAB]  = COMBO(abc_combo, KC_TAB),
+    [BC_ENT]   = COMBO(bc_combo, KC_ENT),
+    [DE_SPC]   = COMBO(de_combo, KC_SPC),
+    [GHIJ_DEL] = COMBO(ghij_combo, KC_DEL),
+};
+
+uint16_t get_combo_term(uint16_t combo_index, combo_t *combo) {
+    switch (combo_index) {
+        case DE_SPC:
+            return 20;
+        case GHIJ_DEL:
+            return 500;
+        default:
+            return COMBO_TERM;
+    }
+}
@@ -0,0 +1,189 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+using testing::_;
+using testing::AnyNumber;
+using testing::AtLeast;
+using testing::InSequence;
+
+class ComboOverlap : public TestFixture {
+   protected:
+    // The matrix scan handles one key change per loop
+    void press(uint8_t col) {
+        press_key(col, 0);
+        run_one_scan_loop();
+    }
+
+    void release(uint8_t col) {
+        release_key(col, 0);
+        run_one_scan_loop();
+    }
+};
+
+TEST_F(ComboOverlap, LongestComboWins) {
+    TestDriver driver;
+    InSequence s;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    press(0);
+    press(1);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_TAB)));
+    press(2);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AtLeast(1));
+    release(0);
+    release(1);
+    release(2);
+}
+
+TEST_F(ComboOverlap, ShorterComboFiresAfterItsTerm) {
+    TestDriver driver;
+    InSequence s;
+    press(0);
+    press(1);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_ESC)));
+    idle_for(COMBO_TERM);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AtLeast(1));
+    release(0);
+    release(1);
+}
+
+TEST_F(ComboOverlap, ShorterComboFiresOnRelease) {
+    TestDriver driver;
+    InSequence s;
+    press(0);
+    press(1);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_ESC)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AtLeast(1));
+    release(0);
+    release(1);
+}
+
+TEST_F(ComboOverlap, OtherKeyResolvesComboWithoutWaiting) {
+    TestDriver driver;
+    InSequence s;
+    press(0);
+    press(1);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_ESC)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_ESC, KC_F)));
+    press(5);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    release(0);
+    release(1);
+    release(5);
+}
+
+TEST_F(ComboOverlap, CombosShareKeys) {
+    TestDriver driver;
+    InSequence s;
+    press(1);
+    // B+C could still become A+B+C
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    press(2);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_ENT)));
+    idle_for(COMBO_TERM);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AtLeast(1));
+    release(1);
+    release(2);
+}
+
+TEST_F(ComboOverlap, KeysOutsideTheTermAreSentAsKeys) {
+    TestDriver driver;
+    InSequence s;
+    // D+E has a 20ms term
+    press(3);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_D))).Times(AtLeast(1));
+    idle_for(25);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    press(4);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_D, KC_E))).Times(AtLeast(1));
+    idle_for(25);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    release(3);
+    release(4);
+}
+
+TEST_F(ComboOverlap, LongComboUsesItsOwnTerm) {
+    TestDriver driver;
+    InSequence s;
+    // G+H+I+J has a 500ms term, longer than COMBO_TERM
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    press(6);
+    idle_for(COMBO_TERM);
+    press(7);
+    idle_for(COMBO_TERM);
+    press(8);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_DEL)));
+    press(9);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AtLeast(1));
+    release(6);
+    release(7);
+    release(8);
+    release(9);
+}
+
+TEST_F(ComboOverlap, OtherKeySendsPendingKeys) {
+    TestDriver driver;
+    InSequence s;
+    press(0);
+    // Flushing the buffered key sends its report twice
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A))).Times(2);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A, KC_F)));
+    press(5);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    release(5);
+    release(0);
+}
+
+TEST_F(ComboOverlap, RepeatedCombosWrapTheKeyBuffer) {
+    TestDriver driver;
+    for (int i = 0; i < COMBO_KEY_BUFFER_LENGTH * 3; i++) {
+        InSequence s;
+        press(0);
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_TAB)));
+        press(1);
+        press(2);
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AtLeast(1));
+        release(2);
+        release(1);
+        release(0);
+        testing::Mock::VerifyAndClearExpectations(&driver);
+    }
+}
@@ -0,0 +1,159 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include <vector>
+
+extern "C" {
+#include "deferred_exec.h"
+void advance_time(uint32_t ms);
+}
+
+using testing::_;
+using testing::AnyNumber;
+using testing::AtLeast;
+using testing::InSequence;
+
+static int              loop;
+static uint32_t         start;
+static std::vector<int> runs;
+
+// Records the loop it ran in and how late its trigger time was, then repeats after cb_arg ms
+static uint32_t record_run(uint32_t trigger_time, void *cb_arg) {
+    runs.push_back(loop);
+    runs.push_back(trigger_time - start - loop);
+    return (uintptr_t)cb_arg;
+}
+
+class DeferredExec : public TestFixture {
+   protected:
+    void SetUp() override {
+        loop  = 0;
+        start = timer_read32();
+        runs.clear();
+        tokens.clear();
+    }
+
+    void TearDown() override {
+        for (deferred_token token : tokens) {
+            cancel_deferred_exec(token);
+        }
+    }
+
+    deferred_token defer(uint32_t delay, uint32_t repeat = 0) {
+        deferred_token token = defer_exec(delay, record_run, (void *)(uintptr_t)repeat);
+        EXPECT_NE(token, INVALID_DEFERRED_TOKEN);
+        tokens.push_back(token);
+        return token;
+    }
+
+    void loops(int count) {
+        for (int i = 0; i < count; i++) {
+            run_one_scan_loop();
+            loop++;
+        }
+    }
+
+    std::vector<deferred_token> tokens;
+};
+
+TEST_F(DeferredExec, RunsOnTimeOnEveryLevel) {
+    TestDriver driver;
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    for (uint32_t delay : {4097, 1, 257, 15, 16, 17, 255, 256, 4095, 4096, 70000}) {
+        defer(delay);
+    }
+    loops(70001);
+    EXPECT_EQ(runs, std::vector<int>({1, 0, 15, 0, 16, 0, 17, 0, 255, 0, 256, 0, 257, 0, 4095, 0, 4096, 0, 4097, 0, 70000, 0}));
+}
+
+TEST_F(DeferredExec, RepeatsUntilZero) {
+    TestDriver driver;
+
+    defer(10, 20);
+    loops(55);
+    EXPECT_EQ(runs, std::vector<int>({10, 0, 30, 0, 50, 0}));
+
+    cancel_deferred_exec(tokens[0]);
+    loops(50);
+    EXPECT_EQ(runs.size(), 6u);
+}
+
+TEST_F(DeferredExec, ExtendAndCancel) {
+    TestDriver driver;
+
+    deferred_token extended  = defer(10);
+    deferred_token cancelled = defer(20);
+    loops(5);
+    EXPECT_TRUE(extend_deferred_exec(extended, 30));
+    EXPECT_TRUE(cancel_deferred_exec(cancelled));
+    EXPECT_FALSE(cancel_deferred_exec(cancelled));
+    loops(50);
+    EXPECT_EQ(runs, std::vector<int>({35, 0}));
+    EXPECT_FALSE(extend_deferred_exec(extended, 10));
+}
+
+TEST_F(DeferredExec, LateCallsAreNotRepeated) {
+    TestDriver driver;
+
+    defer(300, 100);
+    defer(5000);
+    advance_time(6000);
+    loop = 6000;
+    loops(150);
+    // Both run late in the first loop, and the repeat restarts from there
+    EXPECT_EQ(runs, std::vector<int>({6000, -5700, 6000, -1000, 6100, 0}));
+}
+
+TEST_F(DeferredExec, TapDanceTimesOutWithoutScanning) {
+    TestDriver driver;
+    InSequence s;
+
+    press_key(0, 0);
+    run_one_scan_loop();
+    release_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    idle_for(TAPPING_TERM - 1);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AtLeast(1));
+    idle_for(5);
+}
+
+TEST_F(DeferredExec, TapDanceTimesOutWithNoFreeExecutor) {
+    TestDriver driver;
+    InSequence s;
+
+    // Take every executor, the timeout falls back to matrix_scan_tap_dance()
+    for (deferred_token token; (token = defer_exec(60000, record_run, NULL)) != INVALID_DEFERRED_TOKEN;) {
+        tokens.push_back(token);
+    }
+
+    press_key(0, 0);
+    run_one_scan_loop();
+    release_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    idle_for(TAPPING_TERM - 1);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AtLeast(1));
+    idle_for(5);
+}
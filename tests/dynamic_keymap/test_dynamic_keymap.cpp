@@ -0,0 +1,87 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+extern "C" {
+#include "dynamic_keymap.h"
+#include "eeprom.h"
+}
+
+using testing::_;
+using testing::AnyNumber;
+
+class DynamicKeymap : public TestFixture {
+   public:
+    void SetUp() override {
+        dynamic_keymap_reset();
+        dynamic_keymap_init();
+    }
+};
+
+// What is in EEPROM, without going through the cache
+static uint16_t eeprom_keycode(uint8_t layer, uint8_t row, uint8_t col) {
+    const uint8_t* address = (const uint8_t*)dynamic_keymap_key_to_eeprom_address(layer, row, col);
+    return eeprom_read_byte(address) << 8 | eeprom_read_byte(address + 1);
+}
+
+TEST_F(DynamicKeymap, ReadsAfterAWriteComeFromTheCache) {
+    dynamic_keymap_set_keycode(0, 1, 2, KC_Z);
+    EXPECT_EQ(dynamic_keymap_get_keycode(0, 1, 2), KC_Z);
+    EXPECT_EQ(eeprom_keycode(0, 1, 2), KC_M);
+
+    // And so does the keymap
+    TestDriver driver;
+    press_key(2, 1);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_Z)));
+    run_one_scan_loop();
+    release_key(2, 1);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
+
+TEST_F(DynamicKeymap, WritesReachEepromAfterTheDelay) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    dynamic_keymap_set_keycode(0, 0, 0, KC_Z);
+    idle_for(50);
+    // Another change starts the delay over
+    dynamic_keymap_set_keycode(0, 0, 1, KC_Y);
+    // The last scan of these is 1 ms short of the delay
+    idle_for(DYNAMIC_KEYMAP_WRITE_BACK_DELAY);
+    EXPECT_EQ(eeprom_keycode(0, 0, 0), KC_A);
+    EXPECT_EQ(eeprom_keycode(0, 0, 1), KC_B);
+
+    run_one_scan_loop();
+    EXPECT_EQ(eeprom_keycode(0, 0, 0), KC_Z);
+    EXPECT_EQ(eeprom_keycode(0, 0, 1), KC_Y);
+}
+
+TEST_F(DynamicKeymap, ResetKeyboardFlushesTheCache) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    dynamic_keymap_set_keycode(0, 2, 0, KC_Z);
+    reset_keyboard();
+    EXPECT_EQ(eeprom_keycode(0, 2, 0), KC_Z);
+}
+
+TEST_F(DynamicKeymap, UncachedLayersGoStraightToEeprom) {
+    dynamic_keymap_set_keycode(1, 0, 0, KC_Z);
+    EXPECT_EQ(eeprom_keycode(1, 0, 0), KC_Z);
+    EXPECT_EQ(dynamic_keymap_get_keycode(1, 0, 0), KC_Z);
+}
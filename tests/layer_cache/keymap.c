@@ -0,0 +1,56 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "quantum.h"
+#include "test_keymap.h"
+
+const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
+    [0] =
+        {
+            {KC_A, KC_B, KC_C, KC_D, KC_E, KC_F, KC_G, KC_H, KC_I, KC_J},
+            {KC_K, KC_L, KC_M, KC_N, KC_O, KC_P, KC_Q, KC_R, KC_S, KC_T},
+            {KC_U, KC_V, KC_W, KC_X, KC_Y, KC_Z, KC_1, KC_2, KC_3, KC_4},
+            {KC_5, KC_6, KC_7, KC_8, KC_9, KC_0, KC_NO, KC_NO, KC_NO, KC_NO},
+        },
+};
+
+// A writable keymap, like the one dynamic keymaps keep in EEPROM
+static uint16_t test_keymap[TEST_KEYMAP_LAYERS][MATRIX_ROWS][MATRIX_COLS];
+uint32_t        test_keymap_lookups = 0;
+
+void test_keymap_reset(void) {
+    for (uint8_t layer = 0; layer < TEST_KEYMAP_LAYERS; layer++) {
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                test_keymap[layer][row][col] = layer == 0 ? pgm_read_word(&keymaps[0][row][col]) : KC_TRNS;
+            }
+        }
+    }
+    layer_lookup_cache_invalidate();
+}
+
+void test_keymap_set_keycode(uint8_t layer, uint8_t row, uint8_t col, uint16_t keycode) {
+    test_keymap[layer][row][col] = keycode;
+    layer_lookup_cache_invalidate_key((keypos_t){.row = row, .col = col});
+}
+
+uint16_t keymap_key_to_keycode(uint8_t layer, keypos_t key) {
+    test_keymap_lookups++;
+    if (layer < TEST_KEYMAP_LAYERS && key.row < MATRIX_ROWS && key.col < MATRIX_COLS) {
+        return test_keymap[layer][key.row][key.col];
+    }
+    return KC_NO;
+}
@@ -0,0 +1,122 @@
+/* Copyright 2020 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include "test_keymap.h"
+#include <chrono>
+#include <iostream>
+
+using testing::_;
+using testing::AnyNumber;
+
+class LayerCache : public TestFixture {
+   protected:
+    TestDriver driver;
+
+    void SetUp() override {
+        // Layer changes send reports to clear the keyboard
+        EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+        test_keymap_reset();
+    }
+
+    // Average time of a layer_switch_get_layer call, optionally forcing every call to walk the layers
+    double time_lookup(bool cached) {
+        const unsigned iterations = 100000;
+        keypos_t       key        = {.col = 0, .row = 0};
+        volatile uint8_t sink     = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < iterations; i++) {
+            if (!cached) {
+                layer_lookup_cache_invalidate();
+            }
+            sink = layer_switch_get_layer(key);
+        }
+        auto end = std::chrono::steady_clock::now();
+        (void)sink;
+        return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+    }
+
+    void benchmark_layers(uint8_t n) {
+        layer_state_set((1UL << n) - 1);
+        keypos_t key = {.col = 0, .row = 0};
+
+        test_keymap_lookups = 0;
+        EXPECT_EQ(layer_switch_get_layer(key), 0);
+        uint32_t walk_lookups = test_keymap_lookups;
+        EXPECT_EQ(walk_lookups, n);
+
+        test_keymap_lookups = 0;
+        EXPECT_EQ(layer_switch_get_layer(key), 0);
+        EXPECT_EQ(test_keymap_lookups, 0u);
+
+        double uncached = time_lookup(false);
+        double cached   = time_lookup(true);
+        std::cout << (unsigned)n << " active layers: " << walk_lookups << " keymap lookups uncached, " << uncached << " ns uncached, " << cached << " ns cached" << std::endl;
+    }
+};
+
+TEST_F(LayerCache, ResolvesTopmostNonTransparentLayer) {
+    test_keymap_set_keycode(3, 1, 2, KC_X);
+    test_keymap_set_keycode(5, 1, 2, KC_Y);
+    layer_state_set((1UL << 3) | (1UL << 5));
+    EXPECT_EQ(layer_switch_get_layer((keypos_t){.col = 2, .row = 1}), 5);
+    EXPECT_EQ(layer_switch_get_layer((keypos_t){.col = 3, .row = 1}), 0);
+}
+
+TEST_F(LayerCache, FollowsLayerStateChanges) {
+    keypos_t key = {.col = 2, .row = 1};
+    test_keymap_set_keycode(3, 1, 2, KC_X);
+    EXPECT_EQ(layer_switch_get_layer(key), 0);
+    layer_on(3);
+    EXPECT_EQ(layer_switch_get_layer(key), 3);
+    layer_off(3);
+    EXPECT_EQ(layer_switch_get_layer(key), 0);
+    default_layer_set(1UL << 3);
+    EXPECT_EQ(layer_switch_get_layer(key), 3);
+    default_layer_set(1UL << 0);
+}
+
+TEST_F(LayerCache, KeymapWriteInvalidatesOnlyThatKey) {
+    keypos_t key   = {.col = 2, .row = 1};
+    keypos_t other = {.col = 3, .row = 1};
+    layer_on(3);
+    EXPECT_EQ(layer_switch_get_layer(key), 0);
+    EXPECT_EQ(layer_switch_get_layer(other), 0);
+
+    test_keymap_set_keycode(3, 1, 2, KC_X);
+    test_keymap_lookups = 0;
+    EXPECT_EQ(layer_switch_get_layer(key), 3);
+    EXPECT_EQ(layer_switch_get_layer(other), 0);
+    EXPECT_EQ(test_keymap_lookups, 1u);
+}
+
+TEST_F(LayerCache, KeyPressUsesResolvedLayer) {
+    test_keymap_set_keycode(3, 0, 0, KC_X);
+    layer_on(3);
+    press_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_X)));
+    keyboard_task();
+    release_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    keyboard_task();
+}
+
+TEST_F(LayerCache, LookupCostWith4ActiveLayers) { benchmark_layers(4); }
+
+TEST_F(LayerCache, LookupCostWith8ActiveLayers) { benchmark_layers(8); }
+
+TEST_F(LayerCache, LookupCostWith16ActiveLayers) { benchmark_layers(16); }
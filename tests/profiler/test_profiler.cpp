@@ -0,0 +1,104 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+extern "C" {
+#include "profiler.h"
+}
+
+using testing::_;
+using testing::InSequence;
+
+// Every read of the clock moves it on by a microsecond
+extern "C" profiler_ticks_t profiler_read(void) {
+    static profiler_ticks_t ticks = 0;
+    return ticks += 1000;
+}
+
+class Profiler : public TestFixture {
+   protected:
+    void SetUp() override { profiler_reset(); }
+
+    profiler_summary_t summary(profiler_probe_t probe) {
+        profiler_summary_t summary;
+        profiler_summary(probe, &summary);
+        return summary;
+    }
+};
+
+TEST_F(Profiler, KeyPressIsProfiled) {
+    TestDriver driver;
+    InSequence s;
+
+    press_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    run_one_scan_loop();
+    release_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+
+    EXPECT_EQ(summary(PROFILER_MATRIX_SCAN).count, 2u);
+    EXPECT_EQ(summary(PROFILER_ACTION_EXEC).count, 2u);
+    EXPECT_EQ(summary(PROFILER_SEND_KEYBOARD).count, 2u);
+    EXPECT_EQ(summary(PROFILER_SEND_KEYBOARD).max, 1u);
+    // The report is sent from within action_exec
+    EXPECT_GT(summary(PROFILER_ACTION_EXEC).min, summary(PROFILER_SEND_KEYBOARD).max);
+
+    // Idle loops only run the scan
+    idle_for(10);
+    EXPECT_EQ(summary(PROFILER_MATRIX_SCAN).count, 12u);
+    EXPECT_EQ(summary(PROFILER_ACTION_EXEC).count, 2u);
+}
+
+TEST_F(Profiler, Summary) {
+    for (int i = 0; i < 990; i++) {
+        profiler_record(PROFILER_USER, 10000);
+    }
+    for (int i = 0; i < 10; i++) {
+        profiler_record(PROFILER_USER, 1000000);
+    }
+
+    profiler_summary_t s = summary(PROFILER_USER);
+    EXPECT_EQ(s.count, 1000u);
+    EXPECT_EQ(s.min, 10u);
+    EXPECT_EQ(s.avg, 19u);
+    EXPECT_EQ(s.max, 1000u);
+    // The top 1% is left out, the rest is rounded up to its power of two bucket
+    EXPECT_EQ(s.p99, 16u);
+
+    profiler_record(PROFILER_USER, 1000000);
+    EXPECT_EQ(summary(PROFILER_USER).p99, 1000u);
+
+    profiler_reset();
+    EXPECT_EQ(summary(PROFILER_USER).count, 0u);
+}
+
+TEST_F(Profiler, RawHidReport) {
+    profiler_record(PROFILER_USER, 5000);
+    profiler_record(PROFILER_USER, 300000);
+
+    uint8_t data[32] = {0};
+    EXPECT_EQ(profiler_raw_hid_report(PROFILER_USER, data, PROFILER_RAW_HID_REPORT_SIZE - 1), 0);
+    ASSERT_EQ(profiler_raw_hid_report(PROFILER_USER, data, sizeof(data)), PROFILER_RAW_HID_REPORT_SIZE);
+
+    const uint8_t expected[PROFILER_RAW_HID_REPORT_SIZE] = {
+        PROFILER_USER, 2, 0, 0, 0, 5, 0, 0, 0, 0x98, 0, 0, 0, 0x2C, 0x01, 0, 0, 0x2C, 0x01, 0, 0,
+    };
+    for (uint8_t i = 0; i < PROFILER_RAW_HID_REPORT_SIZE; i++) {
+        EXPECT_EQ(data[i], expected[i]) << "byte " << (int)i;
+    }
+}
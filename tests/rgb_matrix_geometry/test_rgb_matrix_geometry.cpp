@@ -0,0 +1,166 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+extern "C" {
+#include "rgb_matrix.h"
+#include "color.h"
+
+extern uint32_t color_checksum;
+
+bool BAND_PINWHEEL_SAT(effect_params_t *params);
+bool CYCLE_PINWHEEL(effect_params_t *params);
+bool BAND_SPIRAL_VAL(effect_params_t *params);
+bool CYCLE_SPIRAL(effect_params_t *params);
+bool CYCLE_OUT_IN(effect_params_t *params);
+bool SPLASH(effect_params_t *params);
+bool MULTISPLASH(effect_params_t *params);
+bool SOLID_REACTIVE_MULTINEXUS(effect_params_t *params);
+}
+
+typedef bool (*effect_f)(effect_params_t *params);
+
+// Both the cached and the uncached build must produce these colors
+struct effect_case {
+    const char *name;
+    effect_f    effect;
+    uint32_t    checksum;
+};
+
+static const effect_case effects[] = {
+    {"BAND_PINWHEEL_SAT", BAND_PINWHEEL_SAT, 2298966280},
+    {"CYCLE_PINWHEEL", CYCLE_PINWHEEL, 3858238773},
+    {"BAND_SPIRAL_VAL", BAND_SPIRAL_VAL, 3339726592},
+    {"CYCLE_SPIRAL", CYCLE_SPIRAL, 1278578742},
+    {"CYCLE_OUT_IN", CYCLE_OUT_IN, 1878581369},
+    {"SPLASH", SPLASH, 319613440},
+    {"MULTISPLASH", MULTISPLASH, 2157186341},
+    {"SOLID_REACTIVE_MULTINEXUS", SOLID_REACTIVE_MULTINEXUS, 1969391360},
+};
+
+class RgbMatrixGeometry : public TestFixture {
+   protected:
+    void SetUp() override {
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                uint8_t led                      = row * MATRIX_COLS + col;
+                g_led_config.matrix_co[row][col] = led;
+                g_led_config.point[led]          = {(uint8_t)(col * 15), (uint8_t)(row * 9)};
+                g_led_config.flags[led]          = LED_FLAG_KEYLIGHT;
+            }
+        }
+#ifdef RGB_MATRIX_GEOMETRY_CACHE
+        rgb_matrix_update_led_geometry();
+#endif
+        rgb_matrix_config.hsv   = {32, 255, 255};
+        rgb_matrix_config.speed = 127;
+        g_rgb_timer             = 12345;
+        set_hits(0);
+    }
+
+    // Eight hits, the newest at the end
+    void set_hits(uint8_t first_led) {
+        g_last_hit_tracker.count = LED_HITS_TO_REMEMBER;
+        for (uint8_t j = 0; j < LED_HITS_TO_REMEMBER; j++) {
+            uint8_t led                 = first_led + j * 13;
+            g_last_hit_tracker.index[j] = led;
+            g_last_hit_tracker.x[j]     = g_led_config.point[led].x;
+            g_last_hit_tracker.y[j]     = g_led_config.point[led].y;
+            g_last_hit_tracker.tick[j]  = 40 + j * 20;
+        }
+    }
+
+    uint32_t render(effect_f effect) {
+        effect_params_t params = {0, LED_FLAG_ALL, false};
+        color_checksum         = 0;
+        effect(&params);
+        return color_checksum;
+    }
+};
+
+TEST_F(RgbMatrixGeometry, EffectsProduceTheSameColors) {
+    for (auto &e : effects) {
+        EXPECT_EQ(render(e.effect), e.checksum) << e.name;
+    }
+}
+
+TEST_F(RgbMatrixGeometry, SplashSurvivesChangingHits) {
+    uint32_t first = render(SPLASH);
+    set_hits(5);
+    render(SPLASH);
+    set_hits(0);
+    EXPECT_EQ(render(SPLASH), first);
+}
+
+TEST_F(RgbMatrixGeometry, Benchmark) {
+    const int frames = 2000;
+    for (auto &e : effects) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < frames; i++) {
+            render(e.effect);
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        printf("%-26s %8lld ns/frame\n", e.name, (long long)(elapsed / frames));
+    }
+}
+
+TEST(HsvToRgbBatch, MatchesSingleConversion) {
+    HSV hsv[256];
+    RGB rgb[256];
+    for (int s = 0; s < 256; s++) {
+        for (int v = 0; v < 256; v++) {
+            for (int h = 0; h < 256; h++) {
+                hsv[h] = {(uint8_t)h, (uint8_t)s, (uint8_t)v};
+            }
+            hsv_to_rgb_batch(hsv, rgb, 255);
+            hsv_to_rgb_batch(&hsv[255], &rgb[255], 1);
+            for (int h = 0; h < 256; h++) {
+                RGB expected = hsv_to_rgb(hsv[h]);
+                ASSERT_EQ(memcmp(&rgb[h], &expected, sizeof(RGB)), 0) << h << " " << s << " " << v;
+            }
+        }
+    }
+}
+
+TEST(HsvToRgbBatch, Benchmark) {
+    const int rounds = 2000;
+    HSV       hsv[DRIVER_LED_TOTAL];
+    RGB       rgb[DRIVER_LED_TOTAL];
+    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+        hsv[i] = {(uint8_t)(i * 7), (uint8_t)(255 - i), 200};
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+            rgb[i] = hsv_to_rgb(hsv[i]);
+        }
+    }
+    auto single = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        hsv_to_rgb_batch(hsv, rgb, DRIVER_LED_TOTAL);
+    }
+    auto batch = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    printf("hsv_to_rgb       %8lld ns/frame\n", (long long)(single / rounds));
+    printf("hsv_to_rgb_batch %8lld ns/frame\n", (long long)(batch / rounds));
+}
@@ -0,0 +1,100 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+using testing::_;
+using testing::AnyNumber;
+
+extern "C" {
+#include "rgb_matrix.h"
+
+extern uint32_t flush_count;
+extern uint32_t render_chunk_cost;
+extern uint32_t render_chunks;
+}
+
+class RgbMatrixGovernor : public TestFixture {
+   protected:
+    TestDriver driver;
+
+    void SetUp() override {
+        EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+        render_chunk_cost = 0;
+        rgb_matrix_mode_noeeprom(RGB_MATRIX_SOLID_COLOR);
+        // finish the frame the mode change started
+        idle_for(50);
+        rgb_matrix_clear_stats();
+        flush_count   = 0;
+        render_chunks = 0;
+    }
+
+    void TearDown() override { render_chunk_cost = 0; }
+
+    // Runs until the next frame starts rendering
+    void run_to_next_frame() {
+        rgb_matrix_mode_noeeprom(RGB_MATRIX_SOLID_COLOR);
+        run_one_scan_loop();
+        render_chunks = 0;
+    }
+};
+
+TEST_F(RgbMatrixGovernor, FastFrameRendersInOneRun) {
+    run_to_next_frame();
+    run_one_scan_loop();
+    EXPECT_EQ(render_chunks, 8u);
+    run_one_scan_loop();
+    EXPECT_EQ(flush_count, 1u);
+    EXPECT_EQ(rgb_matrix_get_stats()->budget_overruns, 0u);
+}
+
+TEST_F(RgbMatrixGovernor, SlowFrameIsSpreadOverRuns) {
+    render_chunk_cost = 1;
+    run_to_next_frame();
+    run_one_scan_loop();
+    EXPECT_EQ(render_chunks, 2u);
+    run_one_scan_loop();
+    EXPECT_EQ(render_chunks, 4u);
+    idle_for(2);
+    EXPECT_EQ(render_chunks, 8u);
+    EXPECT_EQ(flush_count, 0u);
+    run_one_scan_loop();
+    EXPECT_EQ(flush_count, 1u);
+    EXPECT_EQ(rgb_matrix_get_stats()->budget_overruns, 0u);
+}
+
+TEST_F(RgbMatrixGovernor, ChunksPastTheBudgetAreOverruns) {
+    render_chunk_cost = 3;
+    run_to_next_frame();
+    idle_for(8);
+    EXPECT_EQ(render_chunks, 8u);
+    EXPECT_EQ(rgb_matrix_get_stats()->budget_overruns, 8u);
+}
+
+TEST_F(RgbMatrixGovernor, ReportsFramesPerSecond) {
+    idle_for(2000);
+    EXPECT_GE(rgb_matrix_get_stats()->fps, 49u);
+    EXPECT_LE(rgb_matrix_get_stats()->fps, 50u);
+    EXPECT_EQ(rgb_matrix_get_stats()->frames_skipped, 0u);
+}
+
+TEST_F(RgbMatrixGovernor, SlowFramesAreSkipped) {
+    // a frame takes over 40ms, so every other one is dropped
+    render_chunk_cost = 5;
+    idle_for(2000);
+    EXPECT_GT(rgb_matrix_get_stats()->frames_skipped, 0u);
+    EXPECT_LT(rgb_matrix_get_stats()->fps, 25u);
+}
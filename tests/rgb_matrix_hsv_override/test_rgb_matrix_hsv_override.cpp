@@ -0,0 +1,43 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "test_common.hpp"
+
+extern "C" {
+#include "rgb_matrix.h"
+#include "color.h"
+
+extern RGB led_colors[DRIVER_LED_TOTAL];
+
+bool CYCLE_LEFT_RIGHT(effect_params_t *params);
+}
+
+class RgbMatrixHsvOverride : public TestFixture {};
+
+TEST_F(RgbMatrixHsvOverride, BatchedEffectsUseTheKeyboardConversion) {
+    rgb_matrix_config.hsv   = {0, 255, 255};
+    rgb_matrix_config.speed = 127;
+    g_rgb_timer             = 12345;
+
+    effect_params_t params = {0, LED_FLAG_ALL, false};
+    CYCLE_LEFT_RIGHT(&params);
+
+    bool lit = false;
+    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+        EXPECT_EQ(led_colors[i].b, 0) << "LED " << (int)i;
+        lit |= led_colors[i].r || led_colors[i].g;
+    }
+    EXPECT_TRUE(lit);
+}
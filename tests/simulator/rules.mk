@@ -0,0 +1,56 @@
+# Copyright 2021 QMK
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+CUSTOM_MATRIX=yes
+
+# With SIM_KEYBOARD set the simulator is built with that keyboard's config.h
+# files and keymap instead of the ones in this folder. The keyboard's own .c
+# files, matrix and rules.mk are left out, so only the keymap's rules.mk is
+# read, and other features have to be given on the command line.
+ifneq ($(SIM_KEYBOARD),)
+    SIM_KEYMAP ?= default
+
+    SIM_FOLDER_1 := $(SIM_KEYBOARD)
+    SIM_FOLDER_2 := $(patsubst %/,%,$(dir $(SIM_FOLDER_1)))
+    SIM_FOLDER_3 := $(patsubst %/,%,$(dir $(SIM_FOLDER_2)))
+    SIM_FOLDER_4 := $(patsubst %/,%,$(dir $(SIM_FOLDER_3)))
+    SIM_FOLDER_5 := $(patsubst %/,%,$(dir $(SIM_FOLDER_4)))
+    # Outermost first, the way build_keyboard.mk orders them
+    SIM_FOLDERS := $(filter-out .,$(SIM_FOLDER_5) $(SIM_FOLDER_4) $(SIM_FOLDER_3) $(SIM_FOLDER_2) $(SIM_FOLDER_1))
+    SIM_PATHS := $(addprefix keyboards/,$(SIM_FOLDERS))
+
+    ifeq ("$(wildcard keyboards/$(SIM_KEYBOARD)/)","")
+        $(error Could not find keyboard $(SIM_KEYBOARD))
+    endif
+
+    # The innermost keymap folder wins
+    SIM_KEYMAP_PATH := $(lastword $(wildcard $(addsuffix /keymaps/$(SIM_KEYMAP)/keymap.c,$(SIM_PATHS))))
+    ifeq ($(SIM_KEYMAP_PATH),)
+        $(error Could not find keymap $(SIM_KEYMAP) for $(SIM_KEYBOARD))
+    endif
+    SIM_KEYMAP_PATH := $(patsubst %/keymap.c,%,$(SIM_KEYMAP_PATH))
+    -include $(SIM_KEYMAP_PATH)/rules.mk
+
+    TEST_KEYMAP_C := $(SIM_KEYMAP_PATH)/keymap.c
+    TEST_CONFIG_H := $(wildcard $(addsuffix /config.h,$(SIM_PATHS) $(SIM_KEYMAP_PATH)))
+    TEST_CONFIG_H += tests/simulator/sim_config.h
+    VPATH += $(addprefix $(TOP_DIR)/,$(SIM_PATHS) $(SIM_KEYMAP_PATH))
+
+    # The outermost header, as in build_keyboard.mk
+    SIM_KEYBOARD_H := $(firstword $(foreach folder,$(SIM_FOLDERS),$(wildcard keyboards/$(folder)/$(notdir $(folder)).h)))
+    OPT_DEFS += -DSIM_KEYBOARD -DQMK_KEYBOARD=\"$(SIM_KEYBOARD)\" -DQMK_KEYMAP=\"$(SIM_KEYMAP)\"
+    OPT_DEFS += -DQMK_KEYBOARD_H=\"$(notdir $(SIM_KEYBOARD_H))\"
+    OPT_DEFS += $(foreach folder,$(SIM_FOLDERS),-DKEYBOARD_$(subst .,,$(subst /,_,$(folder))))
+endif
@@ -0,0 +1,112 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include "trace_replay.hpp"
+#include <cstdlib>
+#include <iostream>
+
+class Simulator : public TestFixture {};
+
+TEST_F(Simulator, CsvAndJsonTracesAreTheSame) {
+    std::vector<TraceEvent> csv, json;
+    std::string             error;
+
+    ASSERT_TRUE(parse_trace("time,row,col,pressed\n# a tap\n10,0,1,down\n0,0,0,1\n60,0,1,0\n", csv, error)) << error;
+    ASSERT_TRUE(parse_trace("[{\"time\": 0, \"row\": 0, \"col\": 0, \"pressed\": true},\n"
+                            " {\"time\": 60, \"row\": 0, \"col\": 1, \"pressed\": false},\n"
+                            " {\"time\": 10, \"row\": 0, \"col\": 1, \"pressed\": true}]",
+                            json, error))
+        << error;
+    ASSERT_EQ(csv.size(), 3);
+    ASSERT_EQ(json.size(), 3);
+    for (size_t i = 0; i < csv.size(); i++) {
+        EXPECT_EQ(csv[i].time, json[i].time);
+        EXPECT_EQ(csv[i].row, json[i].row);
+        EXPECT_EQ(csv[i].col, json[i].col);
+        EXPECT_EQ(csv[i].pressed, json[i].pressed);
+    }
+    EXPECT_EQ(csv[0].time, 0);
+    EXPECT_EQ(csv[1].time, 10);
+
+    EXPECT_FALSE(parse_trace("0,0,0,1\n5,0,99,1\n", csv, error));
+    EXPECT_EQ(error.find("line 2"), 0);
+}
+
+#ifndef SIM_KEYBOARD
+TEST_F(Simulator, ReportsAreRecordedWithTheirTimes) {
+    TestDriver              driver;
+    TraceReplay             replay(driver);
+    std::vector<TraceEvent> events;
+    std::string             error;
+
+    ASSERT_TRUE(parse_trace("0,0,0,1\n30,0,0,0\n", events, error)) << error;
+    replay.run(events, 10);
+
+    ASSERT_EQ(replay.report_count(RecordedReport::KEYBOARD), 2);
+    const auto& reports = replay.reports();
+    EXPECT_EQ(reports[0].time, 0);
+    EXPECT_EQ(reports[1].time, 30);
+    EXPECT_EQ(reports[0].data[2], KC_A);
+    EXPECT_EQ(reports[1].data[2], KC_NO);
+
+    LatencySummary latency = replay.report_latency();
+    EXPECT_EQ(latency.count, 2);
+    EXPECT_EQ(latency.max, 0);
+    EXPECT_EQ(replay.processing_latency().count, 2);
+}
+
+TEST_F(Simulator, ModTapTapIsReportedOnRelease) {
+    TestDriver              driver;
+    TraceReplay             replay(driver);
+    std::vector<TraceEvent> events;
+    std::string             error;
+
+    ASSERT_TRUE(parse_trace("0,0,1,1\n50,0,1,0\n", events, error)) << error;
+    replay.run(events, 10);
+
+    ASSERT_EQ(replay.report_count(RecordedReport::KEYBOARD), 2);
+    EXPECT_EQ(replay.reports()[0].time, 50);
+    EXPECT_EQ(replay.reports()[0].data[2], KC_B);
+
+    // The press waits for the release, which is reported at once
+    LatencySummary latency = replay.report_latency();
+    EXPECT_EQ(latency.min, 0);
+    EXPECT_EQ(latency.max, 50);
+}
+#endif
+
+// Replays the trace in SIM_TRACE, and writes the reports to SIM_REPORTS if that is set
+TEST_F(Simulator, ReplayTrace) {
+    const char* trace = getenv("SIM_TRACE");
+    if (!trace) {
+        return;
+    }
+
+    TestDriver              driver;
+    TraceReplay             replay(driver);
+    std::vector<TraceEvent> events;
+    std::string             error;
+
+    ASSERT_TRUE(load_trace(trace, events, error)) << error;
+    replay.run(events, TAPPING_TERM + 10);
+    replay.print_summary(std::cout);
+
+    const char* output = getenv("SIM_REPORTS");
+    if (output) {
+        EXPECT_TRUE(replay.write_reports(output)) << "can't write " << output;
+    }
+}
@@ -0,0 +1,90 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+using testing::_;
+using testing::InSequence;
+
+extern "C" {
+extern uint32_t tapping_term_lookups;
+extern uint32_t permissive_hold_lookups;
+extern keypos_t permissive_hold_key;
+}
+
+class TappingTermPerKey : public TestFixture {
+   protected:
+    void SetUp() override {
+        tapping_term_lookups    = 0;
+        permissive_hold_lookups = 0;
+    }
+};
+
+TEST_F(TappingTermPerKey, HoldUsesTheKeysTerm) {
+    TestDriver driver;
+    InSequence s;
+
+    press_key(1, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    idle_for(100);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
+    run_one_scan_loop();
+    release_key(1, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    idle_for(10);
+}
+
+TEST_F(TappingTermPerKey, TermIsLookedUpOncePerEvent) {
+    TestDriver driver;
+    InSequence s;
+
+    press_key(2, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    idle_for(TAPPING_TERM - 10);
+    EXPECT_EQ(tapping_term_lookups, 1u);
+    // only asked about keys typed while the tap key is held
+    EXPECT_EQ(permissive_hold_lookups, 0u);
+
+    release_key(2, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_Q)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    idle_for(5);
+    // once more for the release, which then becomes the tapping key
+    EXPECT_EQ(tapping_term_lookups, 2u);
+    EXPECT_EQ(permissive_hold_lookups, 0u);
+}
+
+TEST_F(TappingTermPerKey, PermissiveHoldGetsTheInterruptingKey) {
+    TestDriver driver;
+    InSequence s;
+
+    press_key(3, 0);
+    run_one_scan_loop();
+    press_key(0, 0);
+    run_one_scan_loop();
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LALT)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LALT, KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LALT)));
+    release_key(0, 0);
+    run_one_scan_loop();
+    EXPECT_EQ(permissive_hold_lookups, 1u);
+    EXPECT_EQ(permissive_hold_key.col, 0);
+    EXPECT_EQ(permissive_hold_key.row, 0);
+
+    release_key(3, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
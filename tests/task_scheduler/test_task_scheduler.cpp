@@ -0,0 +1,117 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include <vector>
+
+extern "C" {
+#include "scheduler.h"
+}
+
+using testing::_;
+using testing::AnyNumber;
+
+static int              loop;
+static std::vector<int> runs_a;
+static std::vector<int> runs_b;
+
+static void task_a(void) { runs_a.push_back(loop); }
+static void task_b(void) { runs_b.push_back(loop); }
+
+class TaskScheduler : public TestFixture {
+   protected:
+    void SetUp() override {
+        loop = 0;
+        runs_a.clear();
+        runs_b.clear();
+        ids.clear();
+    }
+
+    void TearDown() override {
+        for (task_id_t id : ids) {
+            scheduler_remove_task(id);
+        }
+    }
+
+    void add(task_func_t func, uint16_t period, uint16_t deadline, task_priority_t priority) {
+        task_id_t id = scheduler_add_task(func, period, deadline, priority);
+        ASSERT_NE(id, INVALID_TASK_ID);
+        ids.push_back(id);
+    }
+
+    void loops(int count) {
+        for (int i = 0; i < count; i++) {
+            run_one_scan_loop();
+            loop++;
+        }
+    }
+
+    std::vector<task_id_t> ids;
+};
+
+TEST_F(TaskScheduler, TasksRunAtTheirPeriod) {
+    TestDriver driver;
+
+    add(task_a, 10, 0, TASK_PRIORITY_HIGH);
+    add(task_b, 25, 100, TASK_PRIORITY_LOW);
+    loops(100);
+    EXPECT_EQ(runs_a, std::vector<int>({0, 10, 20, 30, 40, 50, 60, 70, 80, 90}));
+    EXPECT_EQ(runs_b, std::vector<int>({0, 25, 50, 75}));
+}
+
+TEST_F(TaskScheduler, LowPriorityTasksTakeTurns) {
+    TestDriver driver;
+
+    add(task_a, 0, 50, TASK_PRIORITY_LOW);
+    add(task_b, 0, 50, TASK_PRIORITY_LOW);
+    loops(10);
+    EXPECT_EQ(runs_a, std::vector<int>({0, 2, 4, 6, 8}));
+    EXPECT_EQ(runs_b, std::vector<int>({1, 3, 5, 7, 9}));
+}
+
+TEST_F(TaskScheduler, NormalPriorityGoesFirst) {
+    TestDriver driver;
+
+    add(task_a, 0, 50, TASK_PRIORITY_LOW);
+    add(task_b, 0, 50, TASK_PRIORITY_NORMAL);
+    loops(10);
+    EXPECT_EQ(runs_b.size(), 10u);
+    // Until the low priority task reaches its deadline
+    EXPECT_TRUE(runs_a.empty());
+    loops(50);
+    EXPECT_EQ(runs_a, std::vector<int>({50}));
+}
+
+TEST_F(TaskScheduler, KeyEventsPostponeLowPriorityTasks) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+
+    add(task_a, 0, 20, TASK_PRIORITY_LOW);
+    add(task_b, 0, 0, TASK_PRIORITY_HIGH);
+    loops(1);
+
+    // One key is handled per loop, so the next 30 loops are all busy
+    for (uint8_t i = 0; i < 30; i++) {
+        press_key(i % MATRIX_COLS, i / MATRIX_COLS);
+    }
+    loops(31);
+    EXPECT_EQ(runs_b.size(), 32u);
+    // Only the deadline gets the low priority task to run, until the keys are done
+    EXPECT_EQ(runs_a, std::vector<int>({0, 20, 31}));
+
+    loops(2);
+    EXPECT_EQ(runs_a, std::vector<int>({0, 20, 31, 32, 33}));
+}
@@ -0,0 +1,262 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "trace_replay.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+extern "C" {
+#include "quantum.h"
+#include "test_matrix.h"
+
+void advance_time(uint32_t ms);
+}
+
+using testing::_;
+using testing::Invoke;
+
+static bool parse_number(const std::string& text, long& value) {
+    char* end;
+    value = strtol(text.c_str(), &end, 10);
+    return !text.empty() && *end == '\0';
+}
+
+static bool parse_pressed(const std::string& text, bool& pressed) {
+    if (text == "1" || text == "down" || text == "true") {
+        pressed = true;
+    } else if (text == "0" || text == "up" || text == "false") {
+        pressed = false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static std::string trim(const std::string& text) {
+    size_t start = text.find_first_not_of(" \t\r\n\"");
+    size_t end   = text.find_last_not_of(" \t\r\n\"");
+    return start == std::string::npos ? "" : text.substr(start, end - start + 1);
+}
+
+static bool make_event(const std::string& time, const std::string& row, const std::string& col, const std::string& pressed, TraceEvent& event) {
+    long t, r, c;
+    if (!parse_number(time, t) || !parse_number(row, r) || !parse_number(col, c) || !parse_pressed(pressed, event.pressed)) {
+        return false;
+    }
+    if (t < 0 || r < 0 || r >= MATRIX_ROWS || c < 0 || c >= MATRIX_COLS) {
+        return false;
+    }
+    event.time = t;
+    event.row  = r;
+    event.col  = c;
+    return true;
+}
+
+static bool parse_csv(const std::string& text, std::vector<TraceEvent>& events, std::string& error) {
+    std::istringstream lines(text);
+    std::string        line;
+    for (int number = 1; std::getline(lines, line); number++) {
+        line = trim(line);
+        if (line.empty() || line[0] == '#' || (number == 1 && !isdigit((unsigned char)line[0]))) {
+            continue;  // comments and the header
+        }
+
+        std::vector<std::string> fields;
+        std::istringstream       cells(line);
+        std::string              cell;
+        while (std::getline(cells, cell, ',')) {
+            fields.push_back(trim(cell));
+        }
+        TraceEvent event;
+        if (fields.size() != 4 || !make_event(fields[0], fields[1], fields[2], fields[3], event)) {
+            error = "line " + std::to_string(number) + ": expected time,row,col,pressed within the matrix";
+            return false;
+        }
+        events.push_back(event);
+    }
+    return true;
+}
+
+// Only handles the flat objects that traces are made of
+static bool parse_json(const std::string& text, std::vector<TraceEvent>& events, std::string& error) {
+    size_t pos = text.find('[') + 1;
+    while ((pos = text.find('{', pos)) != std::string::npos) {
+        size_t end = text.find('}', pos);
+        if (end == std::string::npos) {
+            error = "unterminated object at offset " + std::to_string(pos);
+            return false;
+        }
+
+        std::string        object = text.substr(pos + 1, end - pos - 1);
+        std::string        time, row, col, pressed;
+        std::istringstream members(object);
+        std::string        member;
+        while (std::getline(members, member, ',')) {
+            size_t colon = member.find(':');
+            if (colon == std::string::npos) {
+                continue;
+            }
+            std::string key   = trim(member.substr(0, colon));
+            std::string value = trim(member.substr(colon + 1));
+            if (key == "time") {
+                time = value;
+            } else if (key == "row") {
+                row = value;
+            } else if (key == "col") {
+                col = value;
+            } else if (key == "pressed") {
+                pressed = value;
+            }
+        }
+
+        TraceEvent event;
+        if (!make_event(time, row, col, pressed, event)) {
+            error = "object at offset " + std::to_string(pos) + ": expected time, row, col and pressed within the matrix";
+            return false;
+        }
+        events.push_back(event);
+        pos = end + 1;
+    }
+    return true;
+}
+
+bool parse_trace(const std::string& text, std::vector<TraceEvent>& events, std::string& error) {
+    events.clear();
+    size_t first = text.find_first_not_of(" \t\r\n");
+    bool   ok    = first != std::string::npos && text[first] == '[' ? parse_json(text, events, error) : parse_csv(text, events, error);
+    std::stable_sort(events.begin(), events.end(), [](const TraceEvent& a, const TraceEvent& b) { return a.time < b.time; });
+    return ok;
+}
+
+bool load_trace(const std::string& path, std::vector<TraceEvent>& events, std::string& error) {
+    std::ifstream file(path);
+    if (!file) {
+        error = "can't open " + path;
+        return false;
+    }
+    std::stringstream text;
+    text << file.rdbuf();
+    return parse_trace(text.str(), events, error);
+}
+
+TraceReplay::TraceReplay(TestDriver& driver) {
+    EXPECT_CALL(driver, send_keyboard_mock(_)).WillRepeatedly(Invoke([this](report_keyboard_t& report) { record(RecordedReport::KEYBOARD, &report, sizeof(report)); }));
+    EXPECT_CALL(driver, send_mouse_mock(_)).WillRepeatedly(Invoke([this](report_mouse_t& report) { record(RecordedReport::MOUSE, &report, sizeof(report)); }));
+    EXPECT_CALL(driver, send_system_mock(_)).WillRepeatedly(Invoke([this](uint16_t data) { record(RecordedReport::SYSTEM, &data, sizeof(data)); }));
+    EXPECT_CALL(driver, send_consumer_mock(_)).WillRepeatedly(Invoke([this](uint16_t data) { record(RecordedReport::CONSUMER, &data, sizeof(data)); }));
+}
+
+void TraceReplay::record(RecordedReport::Type type, const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    m_reports.push_back({type, timer_read32() - m_start, std::vector<uint8_t>(bytes, bytes + size)});
+}
+
+void TraceReplay::run(const std::vector<TraceEvent>& events, uint32_t settle_ms) {
+    m_reports.clear();
+    m_event_times.clear();
+    m_processing_us.clear();
+    m_start    = timer_read32();
+    m_duration = (events.empty() ? 0 : events.back().time) + settle_ms;
+
+    size_t next = 0;
+    for (uint32_t now = 0; now <= m_duration; now++) {
+        size_t first = next;
+        for (; next < events.size() && events[next].time <= now; next++) {
+            const TraceEvent& event = events[next];
+            if (event.pressed) {
+                press_key(event.col, event.row);
+            } else {
+                release_key(event.col, event.row);
+            }
+            m_event_times.push_back(now);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        keyboard_task();
+        auto   end = std::chrono::steady_clock::now();
+        double us  = std::chrono::duration<double, std::micro>(end - start).count();
+        m_processing_us.insert(m_processing_us.end(), next - first, us);
+        advance_time(1);
+    }
+}
+
+size_t TraceReplay::report_count(RecordedReport::Type type) const {
+    return std::count_if(m_reports.begin(), m_reports.end(), [type](const RecordedReport& report) { return report.type == type; });
+}
+
+static LatencySummary summarize(std::vector<double> values) {
+    LatencySummary summary = {values.size(), 0, 0, 0, 0};
+    if (values.empty()) {
+        return summary;
+    }
+    std::sort(values.begin(), values.end());
+    double total = 0;
+    for (double value : values) {
+        total += value;
+    }
+    summary.min = values.front();
+    summary.avg = total / values.size();
+    summary.max = values.back();
+    summary.p99 = values[(values.size() * 99) / 100 < values.size() ? (values.size() * 99) / 100 : values.size() - 1];
+    return summary;
+}
+
+LatencySummary TraceReplay::processing_latency() const { return summarize(m_processing_us); }
+
+LatencySummary TraceReplay::report_latency() const {
+    std::vector<double> latencies;
+    for (uint32_t time : m_event_times) {
+        auto report = std::lower_bound(m_reports.begin(), m_reports.end(), time, [](const RecordedReport& report, uint32_t time) { return report.time < time; });
+        if (report != m_reports.end()) {
+            latencies.push_back(report->time - time);
+        }
+    }
+    return summarize(latencies);
+}
+
+static void print_latency(std::ostream& out, const char* name, const LatencySummary& summary, const char* unit) {
+    out << name << ": min " << summary.min << " avg " << summary.avg << " max " << summary.max << " p99 " << summary.p99 << " " << unit << " (" << summary.count << " events)" << std::endl;
+}
+
+void TraceReplay::print_summary(std::ostream& out) const {
+    out << "Replayed " << m_event_times.size() << " events over " << m_duration << " ms" << std::endl;
+    out << "Reports: " << report_count(RecordedReport::KEYBOARD) << " keyboard, " << report_count(RecordedReport::MOUSE) << " mouse, " << report_count(RecordedReport::SYSTEM) << " system, " << report_count(RecordedReport::CONSUMER) << " consumer" << std::endl;
+    print_latency(out, "Processing latency", processing_latency(), "us");
+    print_latency(out, "Report latency", report_latency(), "ms");
+}
+
+bool TraceReplay::write_reports(const std::string& path) const {
+    static const char* const names[] = {"keyboard", "mouse", "system", "consumer"};
+
+    std::ofstream file(path);
+    if (!file) {
+        return false;
+    }
+    file << "time,type,data" << std::endl;
+    for (const RecordedReport& report : m_reports) {
+        file << report.time << "," << names[report.type] << ",";
+        for (size_t i = 0; i < report.data.size(); i++) {
+            char hex[4];
+            snprintf(hex, sizeof(hex), i ? " %02X" : "%02X", report.data[i]);
+            file << hex;
+        }
+        file << std::endl;
+    }
+    return true;
+}
@@ -0,0 +1,84 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "test_driver.hpp"
+
+struct TraceEvent {
+    uint32_t time;  // ms from the start of the trace
+    uint8_t  row;
+    uint8_t  col;
+    bool     pressed;
+};
+
+struct RecordedReport {
+    enum Type { KEYBOARD, MOUSE, SYSTEM, CONSUMER };
+    Type                 type;
+    uint32_t             time;  // ms from the start of the trace
+    std::vector<uint8_t> data;
+};
+
+struct LatencySummary {
+    size_t count;
+    double min;
+    double avg;
+    double max;
+    double p99;
+};
+
+/* Traces are either CSV lines of "time,row,col,pressed", with pressed being
+ * 1/0, down/up or true/false, or a JSON array of objects with the same keys.
+ * Events are sorted by time. On failure error says what was wrong and where.
+ */
+bool parse_trace(const std::string& text, std::vector<TraceEvent>& events, std::string& error);
+bool load_trace(const std::string& path, std::vector<TraceEvent>& events, std::string& error);
+
+/* Replays a trace through the test matrix and keyboard_task(), one scan per
+ * ms, and records every report sent to the driver with its time.
+ */
+class TraceReplay {
+   public:
+    explicit TraceReplay(TestDriver& driver);
+
+    // Keeps scanning for settle_ms after the last event
+    void run(const std::vector<TraceEvent>& events, uint32_t settle_ms);
+
+    const std::vector<RecordedReport>& reports() const { return m_reports; }
+    size_t                             report_count(RecordedReport::Type type) const;
+
+    // Host time spent in the keyboard_task() call that picked up each event, in us
+    LatencySummary processing_latency() const;
+    // Time from each event to the next report, in ms, for the events followed by one
+    LatencySummary report_latency() const;
+
+    void print_summary(std::ostream& out) const;
+    // One "time,type,bytes" CSV line per report, the bytes in hex
+    bool write_reports(const std::string& path) const;
+
+   private:
+    void record(RecordedReport::Type type, const void* data, size_t size);
+
+    std::vector<RecordedReport> m_reports;
+    std::vector<uint32_t>       m_event_times;
+    std::vector<double>         m_processing_us;
+    uint32_t                    m_start = 0;
+    uint32_t                    m_duration = 0;
+};
@@ -0,0 +1,100 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+using testing::InSequence;
+
+class Unicode : public TestFixture {};
+
+static void expect_tap(TestDriver& driver, uint8_t key) {
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(key)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+}
+
+static void expect_held_tap(TestDriver& driver, uint8_t mod, uint8_t key) {
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(mod, key)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(mod)));
+}
+
+TEST_F(Unicode, LinuxTogglesCapsLockOncePerString) {
+    TestDriver driver;
+    InSequence s;
+    set_unicode_input_mode(UC_LNX);
+    driver.set_leds(1 << USB_LED_CAPS_LOCK);
+
+    expect_tap(driver, KC_CAPS);
+    for (auto digits : {std::vector<uint8_t>{KC_0, KC_0, KC_E, KC_9}, std::vector<uint8_t>{KC_0, KC_0, KC_F, KC_C}}) {
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LCTL, KC_LSFT)));
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LCTL, KC_LSFT, KC_U)));
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LCTL, KC_LSFT)));
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+        for (uint8_t digit : digits) {
+            expect_tap(driver, digit);
+        }
+        expect_tap(driver, KC_SPC);
+    }
+    expect_tap(driver, KC_CAPS);
+    send_unicode_string("éü");
+}
+
+TEST_F(Unicode, WinComposeCommitsEachCodePoint) {
+    TestDriver driver;
+    InSequence s;
+    set_unicode_input_mode(UC_WINC);
+
+    for (auto digit : {KC_1, KC_2}) {
+        expect_tap(driver, KC_RALT);
+        expect_tap(driver, KC_U);
+        for (uint8_t hex : {KC_0, KC_0, KC_6, digit}) {
+            expect_tap(driver, hex);
+        }
+        expect_tap(driver, KC_ENTER);
+    }
+    send_unicode_string("ab");
+}
+
+TEST_F(Unicode, MacHoldsOptionForTheWholeString) {
+    TestDriver driver;
+    InSequence s;
+    set_unicode_input_mode(UC_MAC);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LALT)));
+    // U+0061, then U+1F600 as the surrogate pair D83D DE00
+    for (uint8_t digit : {KC_0, KC_0, KC_6, KC_1, KC_D, KC_8, KC_3, KC_D, KC_D, KC_E, KC_0, KC_0}) {
+        expect_held_tap(driver, KC_LALT, digit);
+    }
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    send_unicode_string("a😀");
+}
+
+TEST_F(Unicode, ModsAreRestoredAfterTheString) {
+    TestDriver driver;
+    InSequence s;
+    set_unicode_input_mode(UC_WIN);
+    add_mods(MOD_BIT(KC_LSFT));
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LALT)));
+    expect_held_tap(driver, KC_LALT, KC_PPLS);
+    for (uint8_t digit : {KC_0, KC_0, KC_E, KC_9}) {
+        expect_held_tap(driver, KC_LALT, digit);
+    }
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    // Code points above U+FFFF can't be typed on Windows
+    send_unicode_string("é😀");
+    EXPECT_EQ(get_mods(), MOD_BIT(KC_LSFT));
+    clear_mods();
+}
@@ -0,0 +1,47 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+using testing::InSequence;
+
+class UnicodeHooks : public TestFixture {};
+
+static void expect_tap(TestDriver& driver, uint8_t key) {
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(key)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+}
+
+TEST_F(UnicodeHooks, StringsUseTheOverriddenStartAndFinish) {
+    TestDriver driver;
+    InSequence s;
+    set_unicode_input_mode(UC_LNX);
+    driver.set_leds(1 << USB_LED_CAPS_LOCK);
+
+    expect_tap(driver, KC_CAPS);
+    for (uint8_t digit : {KC_1, KC_2}) {
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LCTL, KC_LSFT)));
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LCTL, KC_LSFT, KC_E)));
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LCTL, KC_LSFT)));
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+        for (uint8_t hex : {(uint8_t)KC_0, (uint8_t)KC_0, (uint8_t)KC_6, digit}) {
+            expect_tap(driver, hex);
+        }
+        expect_tap(driver, KC_ENTER);
+    }
+    expect_tap(driver, KC_CAPS);
+    send_unicode_string("ab");
+}
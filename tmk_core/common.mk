@@ -93,6 +93,16 @@ else
     TMK_COMMON_DEFS += -DNO_DEBUG
 endif
 
+ifeq ($(strip $(PROFILER_ENABLE)), yes)
+    TMK_COMMON_SRC += $(COMMON_DIR)/profiler.c
+    TMK_COMMON_DEFS += -DPROFILER_ENABLE
+endif
+
+ifeq ($(strip $(TASK_SCHEDULER_ENABLE)), yes)
+    TMK_COMMON_SRC += $(COMMON_DIR)/scheduler.c
+    TMK_COMMON_DEFS += -DTASK_SCHEDULER_ENABLE
+endif
+
 ifeq ($(strip $(COMMAND_ENABLE)), yes)
     TMK_COMMON_SRC += $(COMMON_DIR)/command.c
     TMK_COMMON_DEFS += -DCOMMAND_ENABLE
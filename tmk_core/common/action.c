@@ -26,6 +26,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "action_util.h"
 #include "action.h"
 #include "wait.h"
+#include "profiler.h"
 
 #ifdef BACKLIGHT_ENABLE
 #    include "backlight.h"
@@ -70,6 +71,8 @@ __attribute__((weak)) bool get_retro_tapping(uint16_t keycode, keyrecord_t *reco
  * FIXME: Needs documentation.
  */
 void action_exec(keyevent_t event) {
+    PROFILE_START(action);
+
     if (!IS_NOEVENT(event)) {
         dprint("\n---- action_exec: start -----\n");
         dprint("EVENT: ");
@@ -124,6 +127,11 @@ void action_exec(keyevent_t event) {
         dprintln();
     }
 #endif
+
+    // Only key events, the ticks would hide their cost
+    if (!IS_NOEVENT(event)) {
+        PROFILE_END(action, PROFILER_ACTION_EXEC);
+    }
 }
 
 #ifdef SWAP_HANDS_ENABLE
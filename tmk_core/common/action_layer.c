@@ -1,5 +1,7 @@
 #include <stdint.h>
+#include <string.h>
 #include "keyboard.h"
+#include "matrix.h"
 #include "action.h"
 #include "util.h"
 #include "action_layer.h"
@@ -246,11 +248,69 @@ action_t store_or_get_action(bool pressed, keypos_t key) {
 #endif
 }
 
+#if !defined(NO_ACTION_LAYER) && defined(LAYER_LOOKUP_CACHE)
+/** \brief layer lookup cache
+ *
+ * Topmost non-transparent layer of every key, resolved lazily for the layer
+ * state in layer_lookup_cache_state. A cleared bit in layer_lookup_valid means
+ * the entry has to be resolved again.
+ */
+static uint8_t       layer_lookup_cache[MATRIX_ROWS][MATRIX_COLS];
+static matrix_row_t  layer_lookup_valid[MATRIX_ROWS];
+static layer_state_t layer_lookup_cache_state = 0;
+
+/** \brief Layer lookup cache invalidate
+ *
+ * Drops every cached entry, e.g. when the whole keymap was rewritten
+ */
+void layer_lookup_cache_invalidate(void) { memset(layer_lookup_valid, 0, sizeof(layer_lookup_valid)); }
+
+/** \brief Layer lookup cache invalidate key
+ *
+ * Drops the cached entry of a single key, e.g. when one of its keycodes was rewritten
+ */
+void layer_lookup_cache_invalidate_key(keypos_t key) {
+    if (key.row < MATRIX_ROWS && key.col < MATRIX_COLS) {
+        layer_lookup_valid[key.row] &= ~((matrix_row_t)1 << key.col);
+    }
+}
+
+static uint8_t layer_switch_resolve_layer(keypos_t key);
+
+/** \brief Layer switch get layer
+ *
+ * Gets the layer based on key info, from the lookup cache if the layer state didn't change
+ */
+uint8_t layer_switch_get_layer(keypos_t key) {
+    layer_state_t layers = layer_state | default_layer_state;
+    if (layers != layer_lookup_cache_state) {
+        layer_lookup_cache_invalidate();
+        layer_lookup_cache_state = layers;
+    }
+    if (key.row >= MATRIX_ROWS || key.col >= MATRIX_COLS) {
+        return layer_switch_resolve_layer(key);
+    }
+
+    matrix_row_t col_mask = (matrix_row_t)1 << key.col;
+    if (!(layer_lookup_valid[key.row] & col_mask)) {
+        layer_lookup_cache[key.row][key.col] = layer_switch_resolve_layer(key);
+        layer_lookup_valid[key.row] |= col_mask;
+    }
+    return layer_lookup_cache[key.row][key.col];
+}
+
+/** \brief Layer switch resolve layer
+ *
+ * Walks the active layers top-down to find the layer of a key
+ */
+static uint8_t layer_switch_resolve_layer(keypos_t key) {
+#else
 /** \brief Layer switch get layer
  *
  * Gets the layer based on key info
  */
 uint8_t layer_switch_get_layer(keypos_t key) {
+#endif
 #ifndef NO_ACTION_LAYER
     action_t action;
     action.code = ACTION_TRANSPARENT;
@@ -22,7 +22,7 @@
 __attribute__((weak)) uint16_t get_tapping_term(uint16_t keycode, keyrecord_t *record) { return TAPPING_TERM; }
 
 #    ifdef TAPPING_TERM_PER_KEY
-#        define WITHIN_TAPPING_TERM(e) (TIMER_DIFF_16(e.time, tapping_key.event.time) < get_tapping_term(get_event_keycode(tapping_key.event, false), &tapping_key))
+#        define WITHIN_TAPPING_TERM(e) (TIMER_DIFF_16(e.time, tapping_key.event.time) < get_tapping_key_settings()->tapping_term)
 #    else
 #        define WITHIN_TAPPING_TERM(e) (TIMER_DIFF_16(e.time, tapping_key.event.time) < TAPPING_TERM)
 #    endif
@@ -35,14 +35,47 @@ __attribute__((weak)) bool get_tapping_force_hold(uint16_t keycode, keyrecord_t
 __attribute__((weak)) bool get_permissive_hold(uint16_t keycode, keyrecord_t *record) { return false; }
 #    endif
 
+#    if (WAITING_BUFFER_SIZE & (WAITING_BUFFER_SIZE - 1)) != 0 || WAITING_BUFFER_SIZE > 128
+#        error "WAITING_BUFFER_SIZE must be a power of two no larger than 128"
+#    endif
+
+// head and tail run freely and are masked on access, so all slots can be used
+#    define WAITING_BUFFER_AT(i) waiting_buffer[(i) & (WAITING_BUFFER_SIZE - 1)]
+#    define WAITING_BUFFER_COUNT() ((uint8_t)(waiting_buffer_head - waiting_buffer_tail))
+
 static keyrecord_t tapping_key                         = {};
 static keyrecord_t waiting_buffer[WAITING_BUFFER_SIZE] = {};
 static uint8_t     waiting_buffer_head                 = 0;
 static uint8_t     waiting_buffer_tail                 = 0;
+// number of presses and releases in the buffer, so most lookups don't need a scan
+static uint8_t waiting_buffer_presses  = 0;
+static uint8_t waiting_buffer_releases = 0;
+
+#    ifdef TAPPING_TERM_PER_KEY
+// Per key settings of the tapping key, looked up once for each of its events
+// instead of walking the layers again on every check
+typedef struct {
+    keyevent_t event;
+    uint16_t   tapping_term;
+} tapping_key_settings_t;
+
+static tapping_key_settings_t tapping_key_settings = {};
+
+static tapping_key_settings_t *get_tapping_key_settings(void) {
+    if (tapping_key_settings.event.time != tapping_key.event.time || tapping_key_settings.event.pressed != tapping_key.event.pressed || !KEYEQ(tapping_key_settings.event.key, tapping_key.event.key)) {
+        tapping_key_settings.event        = tapping_key.event;
+        tapping_key_settings.tapping_term = get_tapping_term(get_event_keycode(tapping_key.event, false), &tapping_key);
+    }
+    return &tapping_key_settings;
+}
+#    endif
 
 static bool process_tapping(keyrecord_t *record);
 static bool waiting_buffer_enq(keyrecord_t record);
+static void waiting_buffer_deq(void);
 static void waiting_buffer_clear(void);
+static void waiting_buffer_process(void);
+static void waiting_buffer_resolve(void);
 static bool waiting_buffer_typed(keyevent_t event);
 static bool waiting_buffer_has_anykey_pressed(void);
 static void waiting_buffer_scan_tap(void);
@@ -62,11 +95,16 @@ void action_tapping_process(keyrecord_t record) {
         }
     } else {
         if (!waiting_buffer_enq(record)) {
-            // clear all in case of overflow.
-            debug("OVERFLOW: CLEAR ALL STATES\n");
-            clear_keyboard();
-            waiting_buffer_clear();
-            tapping_key = (keyrecord_t){};
+            // settle the tapping key early to make room
+            debug("OVERFLOW: RESOLVE TAPPING KEY\n");
+            waiting_buffer_resolve();
+            if (!waiting_buffer_enq(record)) {
+                // clear all in case of overflow.
+                debug("OVERFLOW: CLEAR ALL STATES\n");
+                clear_keyboard();
+                waiting_buffer_clear();
+                tapping_key = (keyrecord_t){};
+            }
         }
     }
 
@@ -74,17 +112,7 @@ void action_tapping_process(keyrecord_t record) {
     if (!IS_NOEVENT(record.event) && waiting_buffer_head != waiting_buffer_tail) {
         debug("---- action_exec: process waiting_buffer -----\n");
     }
-    for (; waiting_buffer_tail != waiting_buffer_head; waiting_buffer_tail = (waiting_buffer_tail + 1) % WAITING_BUFFER_SIZE) {
-        if (process_tapping(&waiting_buffer[waiting_buffer_tail])) {
-            debug("processed: waiting_buffer[");
-            debug_dec(waiting_buffer_tail);
-            debug("] = ");
-            debug_record(waiting_buffer[waiting_buffer_tail]);
-            debug("\n\n");
-        } else {
-            break;
-        }
-    }
+    waiting_buffer_process();
     if (!IS_NOEVENT(record.event)) {
         debug("\n");
     }
@@ -120,14 +148,15 @@ bool process_tapping(keyrecord_t *keyp) {
                  * useful for long TAPPING_TERM but may prevent fast typing.
                  */
 #    if defined(TAPPING_TERM_PER_KEY) || (TAPPING_TERM >= 500) || defined(PERMISSIVE_HOLD) || defined(PERMISSIVE_HOLD_PER_KEY)
-                else if (
+                // The per key hooks get the interrupting key, and only once it is released
+                else if (IS_RELEASED(event) && waiting_buffer_typed(event)
 #        ifdef TAPPING_TERM_PER_KEY
-                    (get_tapping_term(get_event_keycode(tapping_key.event, false), keyp) >= 500) &&
+                         && (get_tapping_term(get_event_keycode(tapping_key.event, false), keyp) >= 500)
 #        endif
 #        ifdef PERMISSIVE_HOLD_PER_KEY
-                    !get_permissive_hold(get_event_keycode(tapping_key.event, false), keyp) &&
+                         && !get_permissive_hold(get_event_keycode(tapping_key.event, false), keyp)
 #        endif
-                    IS_RELEASED(event) && waiting_buffer_typed(event)) {
+                ) {
                     debug("Tapping: End. No tap. Interfered by typing key\n");
                     process_record(&tapping_key);
                     tapping_key = (keyrecord_t){};
@@ -319,35 +348,91 @@ bool waiting_buffer_enq(keyrecord_t record) {
         return true;
     }
 
-    if ((waiting_buffer_head + 1) % WAITING_BUFFER_SIZE == waiting_buffer_tail) {
+    if (WAITING_BUFFER_COUNT() == WAITING_BUFFER_SIZE) {
         debug("waiting_buffer_enq: Over flow.\n");
         return false;
     }
 
-    waiting_buffer[waiting_buffer_head] = record;
-    waiting_buffer_head                 = (waiting_buffer_head + 1) % WAITING_BUFFER_SIZE;
+    WAITING_BUFFER_AT(waiting_buffer_head) = record;
+    waiting_buffer_head++;
+    if (record.event.pressed) {
+        waiting_buffer_presses++;
+    } else {
+        waiting_buffer_releases++;
+    }
 
     debug("waiting_buffer_enq: ");
     debug_waiting_buffer();
     return true;
 }
 
+/** \brief Waiting buffer deq
+ *
+ * Drops the oldest record, once it has been processed.
+ */
+void waiting_buffer_deq(void) {
+    if (WAITING_BUFFER_AT(waiting_buffer_tail).event.pressed) {
+        waiting_buffer_presses--;
+    } else {
+        waiting_buffer_releases--;
+    }
+    waiting_buffer_tail++;
+}
+
 /** \brief Waiting buffer clear
  *
  * FIXME: Needs docs
  */
 void waiting_buffer_clear(void) {
-    waiting_buffer_head = 0;
-    waiting_buffer_tail = 0;
+    waiting_buffer_head     = 0;
+    waiting_buffer_tail     = 0;
+    waiting_buffer_presses  = 0;
+    waiting_buffer_releases = 0;
+}
+
+/** \brief Waiting buffer process
+ *
+ * Processes buffered records in order, until one has to keep waiting.
+ */
+void waiting_buffer_process(void) {
+    while (waiting_buffer_tail != waiting_buffer_head) {
+        if (!process_tapping(&WAITING_BUFFER_AT(waiting_buffer_tail))) {
+            break;
+        }
+        debug("processed: waiting_buffer[");
+        debug_dec(waiting_buffer_tail & (WAITING_BUFFER_SIZE - 1));
+        debug("] = ");
+        debug_record(WAITING_BUFFER_AT(waiting_buffer_tail));
+        debug("\n\n");
+        waiting_buffer_deq();
+    }
+}
+
+/** \brief Waiting buffer resolve
+ *
+ * Called when the buffer is full. A tap key that is still held is settled as
+ * held, as if its tapping term had run out, and the buffer is processed.
+ */
+void waiting_buffer_resolve(void) {
+    if (IS_TAPPING_PRESSED() && tapping_key.tap.count == 0) {
+        debug("Tapping: End. Buffer full. Not tap(0).\n");
+        process_record(&tapping_key);
+    }
+    tapping_key = (keyrecord_t){};
+    debug_tapping_key();
+    waiting_buffer_process();
 }
 
 /** \brief Waiting buffer typed
  *
- * FIXME: Needs docs
+ * Checks whether the buffer holds the opposite event of the same key.
  */
 bool waiting_buffer_typed(keyevent_t event) {
-    for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i = (i + 1) % WAITING_BUFFER_SIZE) {
-        if (KEYEQ(event.key, waiting_buffer[i].event.key) && event.pressed != waiting_buffer[i].event.pressed) {
+    if ((event.pressed ? waiting_buffer_releases : waiting_buffer_presses) == 0) {
+        return false;
+    }
+    for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i++) {
+        if (KEYEQ(event.key, WAITING_BUFFER_AT(i).event.key) && event.pressed != WAITING_BUFFER_AT(i).event.pressed) {
             return true;
         }
     }
@@ -358,12 +443,7 @@ bool waiting_buffer_typed(keyevent_t event) {
  *
  * FIXME: Needs docs
  */
-__attribute__((unused)) bool waiting_buffer_has_anykey_pressed(void) {
-    for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i = (i + 1) % WAITING_BUFFER_SIZE) {
-        if (waiting_buffer[i].event.pressed) return true;
-    }
-    return false;
-}
+__attribute__((unused)) bool waiting_buffer_has_anykey_pressed(void) { return waiting_buffer_presses > 0; }
 
 /** \brief Scan buffer for tapping
  *
@@ -374,15 +454,17 @@ void waiting_buffer_scan_tap(void) {
     if (tapping_key.tap.count > 0) return;
     // invalid state: tapping_key released && tap.count == 0
     if (!tapping_key.event.pressed) return;
+    // no release to look for
+    if (waiting_buffer_releases == 0) return;
 
-    for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i = (i + 1) % WAITING_BUFFER_SIZE) {
-        if (IS_TAPPING_KEY(waiting_buffer[i].event.key) && !waiting_buffer[i].event.pressed && WITHIN_TAPPING_TERM(waiting_buffer[i].event)) {
-            tapping_key.tap.count       = 1;
-            waiting_buffer[i].tap.count = 1;
+    for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i++) {
+        if (IS_TAPPING_KEY(WAITING_BUFFER_AT(i).event.key) && !WAITING_BUFFER_AT(i).event.pressed && WITHIN_TAPPING_TERM(WAITING_BUFFER_AT(i).event)) {
+            tapping_key.tap.count          = 1;
+            WAITING_BUFFER_AT(i).tap.count = 1;
             process_record(&tapping_key);
 
             debug("waiting_buffer_scan_tap: found at [");
-            debug_dec(i);
+            debug_dec(i & (WAITING_BUFFER_SIZE - 1));
             debug("]\n");
             debug_waiting_buffer();
             return;
@@ -406,11 +488,11 @@ static void debug_tapping_key(void) {
  */
 static void debug_waiting_buffer(void) {
     debug("{ ");
-    for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i = (i + 1) % WAITING_BUFFER_SIZE) {
+    for (uint8_t i = waiting_buffer_tail; i != waiting_buffer_head; i++) {
         debug("[");
-        debug_dec(i);
+        debug_dec(i & (WAITING_BUFFER_SIZE - 1));
         debug("]=");
-        debug_record(waiting_buffer[i]);
+        debug_record(WAITING_BUFFER_AT(i));
         debug(" ");
     }
     debug("}\n");
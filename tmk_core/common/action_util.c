@@ -14,6 +14,7 @@ GNU General Public License for more details.
 You should have received a copy of the GNU General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
+#include <string.h>
 #include "host.h"
 #include "report.h"
 #include "debug.h"
@@ -184,6 +185,85 @@ void clear_oneshot_layer_state(oneshot_fullfillment_t state) {
 bool is_oneshot_layer_active(void) { return get_oneshot_layer_state(); }
 #endif
 
+#ifdef QMK_BATCHED_KEY_EVENTS
+static bool              batch_active  = false;
+static bool              batch_pending = false;
+static report_keyboard_t batch_sent_report;
+static report_keyboard_t batch_pending_report;
+
+/** \brief Check whether replacing the pending report with next would hide a state change
+ *
+ * A key (or mod) that changed between the last sent report and the pending one and
+ * changes back in next would never be seen by the host if the pending report was
+ * simply overwritten, e.g. a tap resolved within the batch.
+ */
+static bool batch_report_toggles_twice(report_keyboard_t *next) {
+    report_keyboard_t *sent    = &batch_sent_report;
+    report_keyboard_t *pending = &batch_pending_report;
+
+    if ((sent->mods ^ pending->mods) & (pending->mods ^ next->mods)) {
+        return true;
+    }
+#    ifdef NKRO_ENABLE
+    if (keyboard_protocol && keymap_config.nkro) {
+        for (uint8_t i = 0; i < KEYBOARD_REPORT_BITS; i++) {
+            if ((sent->nkro.bits[i] ^ pending->nkro.bits[i]) & (pending->nkro.bits[i] ^ next->nkro.bits[i])) {
+                return true;
+            }
+        }
+        return false;
+    }
+#    endif
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        // pressed within the batch and released again
+        uint8_t key = pending->keys[i];
+        if (key && !is_key_pressed(sent, key) && !is_key_pressed(next, key)) {
+            return true;
+        }
+        // released within the batch and pressed again
+        key = sent->keys[i];
+        if (key && !is_key_pressed(pending, key) && is_key_pressed(next, key)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** \brief Defer a keyboard report until the end of the current event batch
+ *
+ * The pending report is only flushed early when the new one would mask a state change.
+ */
+static void batch_queue_report(report_keyboard_t *report) {
+    if (batch_pending && batch_report_toggles_twice(report)) {
+        batch_sent_report = batch_pending_report;
+        host_keyboard_send(&batch_pending_report);
+    }
+    batch_pending_report = *report;
+    batch_pending        = true;
+}
+
+/** \brief Start coalescing keyboard reports
+ *
+ * Every send_keyboard_report() call until keyboard_report_batch_end() is folded into
+ * as few reports as possible, usually one.
+ */
+void keyboard_report_batch_begin(void) {
+    batch_sent_report = *keyboard_report;
+    batch_pending     = false;
+    batch_active      = true;
+}
+
+/** \brief Stop coalescing keyboard reports and send the pending one, if any
+ */
+void keyboard_report_batch_end(void) {
+    batch_active = false;
+    if (batch_pending && memcmp(batch_pending_report.raw, batch_sent_report.raw, KEYBOARD_REPORT_SIZE) != 0) {
+        host_keyboard_send(&batch_pending_report);
+    }
+    batch_pending = false;
+}
+#endif
+
 /** \brief Send keyboard report
  *
  * FIXME: needs doc
@@ -206,6 +286,12 @@ void send_keyboard_report(void) {
         }
     }
 
+#endif
+#ifdef QMK_BATCHED_KEY_EVENTS
+    if (batch_active) {
+        batch_queue_report(keyboard_report);
+        return;
+    }
 #endif
     host_keyboard_send(keyboard_report);
 }
@@ -28,6 +28,11 @@ extern report_keyboard_t *keyboard_report;
 
 void send_keyboard_report(void);
 
+#ifdef QMK_BATCHED_KEY_EVENTS
+void keyboard_report_batch_begin(void);
+void keyboard_report_batch_end(void);
+#endif
+
 /* key */
 inline void add_key(uint8_t key) { add_key_to_report(keyboard_report, key); }
 
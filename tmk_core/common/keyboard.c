@@ -30,6 +30,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "sendchar.h"
 #include "eeconfig.h"
 #include "action_layer.h"
+#include "action_util.h"
 #ifdef BACKLIGHT_ENABLE
 #    include "backlight.h"
 #endif
@@ -95,6 +96,13 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifdef DIP_SWITCH_ENABLE
 #    include "dip_switch.h"
 #endif
+#include "profiler.h"
+#ifdef TASK_SCHEDULER_ENABLE
+#    include "scheduler.h"
+#endif
+#ifdef DEFERRED_EXEC_ENABLE
+#    include "deferred_exec.h"
+#endif
 
 // Only enable this if console is enabled to print to
 #if defined(DEBUG_MATRIX_SCAN_RATE) && defined(CONSOLE_ENABLE)
@@ -161,6 +169,60 @@ static inline bool has_ghost_in_row(uint8_t row, matrix_row_t rowdata) {
 
 #endif
 
+#ifdef QMK_BATCHED_KEY_EVENTS
+#    ifndef QMK_KEY_EVENT_BATCH_SIZE
+#        define QMK_KEY_EVENT_BATCH_SIZE 16
+#    endif
+static keyevent_t key_event_batch[QMK_KEY_EVENT_BATCH_SIZE];
+
+/** \brief Collect the changed keys of the whole matrix into the event batch
+ *
+ * Events are ordered by row and column, and matrix_prev is updated for every
+ * collected key. Changes that do not fit in the batch are picked up by the next scan.
+ */
+static uint8_t keyboard_collect_events(matrix_row_t matrix_prev[]) {
+    uint8_t count = 0;
+
+    for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
+        matrix_row_t matrix_row    = matrix_get_row(r);
+        matrix_row_t matrix_change = matrix_row ^ matrix_prev[r];
+        if (!matrix_change) {
+            continue;
+        }
+#    ifdef MATRIX_HAS_GHOST
+        if (has_ghost_in_row(r, matrix_row)) {
+            continue;
+        }
+#    endif
+        matrix_row_t col_mask = 1;
+        for (uint8_t c = 0; c < MATRIX_COLS; c++, col_mask <<= 1) {
+            if (matrix_change & col_mask) {
+                if (count >= QMK_KEY_EVENT_BATCH_SIZE) {
+                    return count;
+                }
+                key_event_batch[count++] = (keyevent_t){
+                    .key = (keypos_t){.row = r, .col = c}, .pressed = (matrix_row & col_mask), .time = (timer_read() | 1) /* time should not be 0 */
+                };
+                matrix_prev[r] ^= col_mask;
+            }
+        }
+    }
+    return count;
+}
+
+/** \brief Run a collected event batch through the action pipeline
+ *
+ * The keyboard reports generated while processing the batch are coalesced.
+ */
+static void keyboard_dispatch_events(uint8_t count) {
+    keyboard_report_batch_begin();
+    for (uint8_t i = 0; i < count; i++) {
+        action_exec(key_event_batch[i]);
+    }
+    keyboard_report_batch_end();
+}
+#endif
+
 void disable_jtag(void) {
 // To use PF4-7 (PC2-5 on ATmega32A), disable JTAG by writing JTD bit twice within four cycles.
 #if (defined(__AVR_AT90USB646__) || defined(__AVR_AT90USB647__) || defined(__AVR_AT90USB1286__) || defined(__AVR_AT90USB1287__) || defined(__AVR_ATmega16U4__) || defined(__AVR_ATmega32U4__))
@@ -249,6 +311,90 @@ __attribute__((weak)) void housekeeping_task_kb(void) {}
  */
 __attribute__((weak)) void housekeeping_task_user(void) {}
 
+#ifdef OLED_DRIVER_ENABLE
+static void keyboard_oled_task(void) {
+    PROFILE_START(oled);
+    oled_task();
+    PROFILE_END(oled, PROFILER_OLED_TASK);
+}
+#endif
+
+#ifdef TASK_SCHEDULER_ENABLE
+#    ifndef SCHEDULER_LOW_PRIORITY_DEADLINE
+#        define SCHEDULER_LOW_PRIORITY_DEADLINE 20
+#    endif
+
+#    ifdef VISUALIZER_ENABLE
+static void visualizer_task(void) { visualizer_update(default_layer_state, layer_state, visualizer_get_mods(), host_keyboard_leds()); }
+#    endif
+
+#    ifdef VELOCIKEY_ENABLE
+static void velocikey_task(void) {
+    if (velocikey_enabled()) {
+        velocikey_decelerate();
+    }
+}
+#    endif
+
+/** \brief Registers the tasks that run after the matrix scan
+ *
+ * Tasks that talk to the host or read input devices run on every loop. Lighting
+ * and displays run one at a time, in loops where no keys were pressed or released.
+ * Keep scheduler_builtin_tasks in scheduler.h in step, it sizes the task table.
+ */
+static void keyboard_add_tasks(void) {
+    scheduler_init();
+#    ifdef PROFILER_ENABLE
+    scheduler_add_task(profiler_task, 0, SCHEDULER_LOW_PRIORITY_DEADLINE, TASK_PRIORITY_LOW);
+#    endif
+#    if defined(RGBLIGHT_ENABLE)
+    scheduler_add_task(rgblight_task, 0, SCHEDULER_LOW_PRIORITY_DEADLINE, TASK_PRIORITY_LOW);
+#    endif
+#    if defined(BACKLIGHT_ENABLE) && (defined(BACKLIGHT_PIN) || defined(BACKLIGHT_PINS))
+    scheduler_add_task(backlight_task, 0, SCHEDULER_LOW_PRIORITY_DEADLINE, TASK_PRIORITY_LOW);
+#    endif
+#    ifdef ENCODER_ENABLE
+    scheduler_add_task(encoder_read, 0, 0, TASK_PRIORITY_HIGH);
+#    endif
+#    ifdef QWIIC_ENABLE
+    scheduler_add_task(qwiic_task, 0, 0, TASK_PRIORITY_HIGH);
+#    endif
+#    ifdef OLED_DRIVER_ENABLE
+    scheduler_add_task(keyboard_oled_task, 0, SCHEDULER_LOW_PRIORITY_DEADLINE, TASK_PRIORITY_LOW);
+#    endif
+#    ifdef MOUSEKEY_ENABLE
+    scheduler_add_task(mousekey_task, 0, 0, TASK_PRIORITY_HIGH);
+#    endif
+#    ifdef PS2_MOUSE_ENABLE
+    scheduler_add_task(ps2_mouse_task, 0, 0, TASK_PRIORITY_HIGH);
+#    endif
+#    ifdef SERIAL_MOUSE_ENABLE
+    scheduler_add_task(serial_mouse_task, 0, 0, TASK_PRIORITY_HIGH);
+#    endif
+#    ifdef ADB_MOUSE_ENABLE
+    scheduler_add_task(adb_mouse_task, 0, 0, TASK_PRIORITY_HIGH);
+#    endif
+#    ifdef SERIAL_LINK_ENABLE
+    scheduler_add_task(serial_link_update, 0, 0, TASK_PRIORITY_HIGH);
+#    endif
+#    ifdef VISUALIZER_ENABLE
+    scheduler_add_task(visualizer_task, 0, SCHEDULER_LOW_PRIORITY_DEADLINE, TASK_PRIORITY_LOW);
+#    endif
+#    ifdef POINTING_DEVICE_ENABLE
+    scheduler_add_task(pointing_device_task, 0, 0, TASK_PRIORITY_HIGH);
+#    endif
+#    ifdef MIDI_ENABLE
+    scheduler_add_task(midi_task, 0, 0, TASK_PRIORITY_HIGH);
+#    endif
+#    ifdef VELOCIKEY_ENABLE
+    scheduler_add_task(velocikey_task, 0, SCHEDULER_LOW_PRIORITY_DEADLINE, TASK_PRIORITY_LOW);
+#    endif
+#    ifdef JOYSTICK_ENABLE
+    scheduler_add_task(joystick_task, 0, 0, TASK_PRIORITY_HIGH);
+#    endif
+}
+#endif
+
 /** \brief keyboard_init
  *
  * FIXME: needs doc
@@ -308,6 +454,12 @@ void keyboard_init(void) {
 #if defined(DEBUG_MATRIX_SCAN_RATE) && defined(CONSOLE_ENABLE)
     debug_enable = true;
 #endif
+#ifdef PROFILER_ENABLE
+    profiler_init();
+#endif
+#ifdef TASK_SCHEDULER_ENABLE
+    keyboard_add_tasks();
+#endif
 
     keyboard_post_init_kb(); /* Always keep this last */
 }
@@ -327,31 +479,49 @@ void keyboard_init(void) {
 void keyboard_task(void) {
     static matrix_row_t matrix_prev[MATRIX_ROWS];
     static uint8_t      led_status    = 0;
-    matrix_row_t        matrix_row    = 0;
-    matrix_row_t        matrix_change = 0;
+#ifndef QMK_BATCHED_KEY_EVENTS
+    matrix_row_t matrix_row    = 0;
+    matrix_row_t matrix_change = 0;
+#endif
 #ifdef QMK_KEYS_PER_SCAN
     uint8_t keys_processed = 0;
 #endif
+#ifdef TASK_SCHEDULER_ENABLE
+    bool busy = false;
+#endif
 
     housekeeping_task_kb();
     housekeeping_task_user();
 
+    PROFILE_START(scan);
 #if defined(OLED_DRIVER_ENABLE) && !defined(OLED_DISABLE_TIMEOUT)
     uint8_t ret = matrix_scan();
 #else
     matrix_scan();
 #endif
+    PROFILE_END(scan, PROFILER_MATRIX_SCAN);
 
     if (should_process_keypress()) {
+#ifdef QMK_BATCHED_KEY_EVENTS
+        uint8_t events = keyboard_collect_events(matrix_prev);
+        if (events) {
+            if (debug_matrix) matrix_print();
+            keyboard_dispatch_events(events);
+#    ifdef TASK_SCHEDULER_ENABLE
+            busy = true;
+#    endif
+            goto MATRIX_LOOP_END;
+        }
+#else
         for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
             matrix_row    = matrix_get_row(r);
             matrix_change = matrix_row ^ matrix_prev[r];
             if (matrix_change) {
-#ifdef MATRIX_HAS_GHOST
+#    ifdef MATRIX_HAS_GHOST
                 if (has_ghost_in_row(r, matrix_row)) {
                     continue;
                 }
-#endif
+#    endif
                 if (debug_matrix) matrix_print();
                 matrix_row_t col_mask = 1;
                 for (uint8_t c = 0; c < MATRIX_COLS; c++, col_mask <<= 1) {
@@ -361,16 +531,20 @@ void keyboard_task(void) {
                         });
                         // record a processed key
                         matrix_prev[r] ^= col_mask;
-#ifdef QMK_KEYS_PER_SCAN
+#    ifdef TASK_SCHEDULER_ENABLE
+                        busy = true;
+#    endif
+#    ifdef QMK_KEYS_PER_SCAN
                         // only jump out if we have processed "enough" keys.
                         if (++keys_processed >= QMK_KEYS_PER_SCAN)
-#endif
+#    endif
                             // process a key per task call
                             goto MATRIX_LOOP_END;
                     }
                 }
             }
         }
+#endif
     }
     // call with pseudo tick event when no real key event.
 #ifdef QMK_KEYS_PER_SCAN
@@ -385,73 +559,87 @@ MATRIX_LOOP_END:
     matrix_scan_perf_task();
 #endif
 
-#if defined(RGBLIGHT_ENABLE)
-    rgblight_task();
+#ifdef DEFERRED_EXEC_ENABLE
+    // Timeouts can't wait on the scheduler
+    deferred_exec_task();
 #endif
 
-#if defined(BACKLIGHT_ENABLE)
-#    if defined(BACKLIGHT_PIN) || defined(BACKLIGHT_PINS)
+#ifdef TASK_SCHEDULER_ENABLE
+    scheduler_task(busy);
+#else
+#    ifdef PROFILER_ENABLE
+    profiler_task();
+#    endif
+
+#    if defined(RGBLIGHT_ENABLE)
+    rgblight_task();
+#    endif
+
+#    if defined(BACKLIGHT_ENABLE)
+#        if defined(BACKLIGHT_PIN) || defined(BACKLIGHT_PINS)
     backlight_task();
+#        endif
 #    endif
-#endif
 
-#ifdef ENCODER_ENABLE
+#    ifdef ENCODER_ENABLE
     encoder_read();
-#endif
+#    endif
 
-#ifdef QWIIC_ENABLE
+#    ifdef QWIIC_ENABLE
     qwiic_task();
-#endif
+#    endif
 
-#ifdef OLED_DRIVER_ENABLE
-    oled_task();
-#    ifndef OLED_DISABLE_TIMEOUT
-    // Wake up oled if user is using those fabulous keys!
-    if (ret) oled_on();
+#    ifdef OLED_DRIVER_ENABLE
+    keyboard_oled_task();
 #    endif
-#endif
 
-#ifdef MOUSEKEY_ENABLE
+#    ifdef MOUSEKEY_ENABLE
     // mousekey repeat & acceleration
     mousekey_task();
-#endif
+#    endif
 
-#ifdef PS2_MOUSE_ENABLE
+#    ifdef PS2_MOUSE_ENABLE
     ps2_mouse_task();
-#endif
+#    endif
 
-#ifdef SERIAL_MOUSE_ENABLE
+#    ifdef SERIAL_MOUSE_ENABLE
     serial_mouse_task();
-#endif
+#    endif
 
-#ifdef ADB_MOUSE_ENABLE
+#    ifdef ADB_MOUSE_ENABLE
     adb_mouse_task();
-#endif
+#    endif
 
-#ifdef SERIAL_LINK_ENABLE
+#    ifdef SERIAL_LINK_ENABLE
     serial_link_update();
-#endif
+#    endif
 
-#ifdef VISUALIZER_ENABLE
+#    ifdef VISUALIZER_ENABLE
     visualizer_update(default_layer_state, layer_state, visualizer_get_mods(), host_keyboard_leds());
-#endif
+#    endif
 
-#ifdef POINTING_DEVICE_ENABLE
+#    ifdef POINTING_DEVICE_ENABLE
     pointing_device_task();
-#endif
+#    endif
 
-#ifdef MIDI_ENABLE
+#    ifdef MIDI_ENABLE
     midi_task();
-#endif
+#    endif
 
-#ifdef VELOCIKEY_ENABLE
+#    ifdef VELOCIKEY_ENABLE
     if (velocikey_enabled()) {
         velocikey_decelerate();
     }
-#endif
+#    endif
 
-#ifdef JOYSTICK_ENABLE
+#    ifdef JOYSTICK_ENABLE
     joystick_task();
+#    endif
+#endif
+
+#if defined(OLED_DRIVER_ENABLE) && !defined(OLED_DISABLE_TIMEOUT)
+    // Wake up oled if user is using those fabulous keys!
+    if (ret) oled_on();
 #endif
 
     // update LED
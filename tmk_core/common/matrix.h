@@ -57,6 +57,15 @@ void matrix_print(void);
 /* delay between changing matrix pin state and reading values */
 void matrix_io_delay(void);
 
+#ifdef MATRIX_INTERRUPT_SCAN
+/* called from the pin change interrupt to end idle */
+void matrix_wake(void);
+/* whether scanning is paused until a key is pressed */
+bool matrix_is_idle(void);
+/* called in place of a scan while idle */
+void matrix_idle_sleep(void);
+#endif
+
 /* power control */
 void matrix_power_up(void);
 void matrix_power_down(void);
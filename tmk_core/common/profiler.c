@@ -0,0 +1,279 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "profiler.h"
+#include "timer.h"
+#include "print.h"
+
+#if defined(__AVR__)
+#    include <avr/io.h>
+#    include <util/atomic.h>
+#    include "avr/timer_avr.h"
+
+// Timer 0 ticks, on top of the millisecond count
+#    ifndef PROFILER_CLOCK_HZ
+#        define PROFILER_CLOCK_HZ TIMER_RAW_FREQ
+#    endif
+
+extern volatile uint32_t timer_count;
+
+static void profiler_clock_init(void) {}
+
+profiler_ticks_t profiler_read(void) {
+    uint32_t ms;
+    uint8_t  raw;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        ms  = timer_count;
+        raw = TIMER_RAW;
+#    if defined(TIFR0)
+        // The compare match interrupt hasn't run yet
+        if (TIFR0 & _BV(OCF0A)) {
+            ms++;
+            raw = TIMER_RAW;
+        }
+#    endif
+    }
+    return ms * (TIMER_RAW_TOP + 1) + raw;
+}
+
+#elif defined(PROTOCOL_CHIBIOS)
+#    include <hal.h>
+
+#    if defined(DWT_CTRL_CYCCNTENA_Msk)
+// Cortex-M3 and up count CPU cycles
+#        ifndef PROFILER_CLOCK_HZ
+#            if defined(STM32_SYSCLK)
+#                define PROFILER_CLOCK_HZ STM32_SYSCLK
+#            else
+#                error "Define PROFILER_CLOCK_HZ to the CPU clock frequency"
+#            endif
+#        endif
+
+static void profiler_clock_init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+profiler_ticks_t profiler_read(void) { return DWT->CYCCNT; }
+#    else
+// Cortex-M0 has no cycle counter, so fall back to the system tick
+#        define PROFILER_CLOCK_HZ CH_CFG_ST_FREQUENCY
+
+static void profiler_clock_init(void) {}
+
+profiler_ticks_t profiler_read(void) { return chVTGetSystemTimeX(); }
+#    endif
+
+#else
+#    include <time.h>
+
+#    define PROFILER_CLOCK_HZ 1000000000
+
+static void profiler_clock_init(void) {}
+
+__attribute__((weak)) profiler_ticks_t profiler_read(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (profiler_ticks_t)(now.tv_sec * 1000000000ull + now.tv_nsec);
+}
+#endif
+
+typedef struct {
+    uint32_t         count;
+    uint32_t         total;
+    uint32_t         total_count;  // halved together with total before it overflows
+    profiler_ticks_t min;
+    profiler_ticks_t max;
+    uint16_t         buckets[PROFILER_BUCKETS];
+} profiler_stats_t;
+
+static profiler_stats_t profiler_stats[PROFILER_PROBE_COUNT];
+
+#ifdef CONSOLE_ENABLE
+static const char *const profiler_names[PROFILER_USER] = {
+    [PROFILER_MATRIX_SCAN]     = "matrix_scan",
+    [PROFILER_ACTION_EXEC]     = "action_exec",
+    [PROFILER_RGB_MATRIX_TASK] = "rgb_matrix_task",
+    [PROFILER_OLED_TASK]       = "oled_task",
+    [PROFILER_SEND_KEYBOARD]   = "send_keyboard",
+};
+#endif
+
+#if PROFILER_REPORT_INTERVAL > 0
+static uint16_t profiler_report_timer;
+#endif
+
+void profiler_init(void) {
+    profiler_clock_init();
+    profiler_reset();
+#if PROFILER_REPORT_INTERVAL > 0
+    profiler_report_timer = timer_read();
+#endif
+}
+
+void profiler_task(void) {
+#if PROFILER_REPORT_INTERVAL > 0 && defined(CONSOLE_ENABLE)
+    if (timer_elapsed(profiler_report_timer) >= PROFILER_REPORT_INTERVAL) {
+        profiler_report_timer = timer_read();
+        profiler_print();
+        profiler_reset();
+    }
+#endif
+}
+
+uint32_t profiler_ticks_to_us(profiler_ticks_t ticks) {
+#if PROFILER_CLOCK_HZ >= 1000000
+    return ticks / (PROFILER_CLOCK_HZ / 1000000);
+#else
+    return ticks * (1000000 / PROFILER_CLOCK_HZ);
+#endif
+}
+
+static uint8_t profiler_bucket(profiler_ticks_t ticks) {
+    uint8_t bucket = 0;
+    while (ticks > 1 && bucket < PROFILER_BUCKETS - 1) {
+        ticks >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+void profiler_record(profiler_probe_t probe, profiler_ticks_t ticks) {
+    profiler_stats_t *stats = &profiler_stats[probe];
+
+    stats->count++;
+    if (stats->total + ticks < stats->total) {
+        stats->total >>= 1;
+        stats->total_count >>= 1;
+    }
+    stats->total += ticks;
+    stats->total_count++;
+    if (ticks < stats->min) {
+        stats->min = ticks;
+    }
+    if (ticks > stats->max) {
+        stats->max = ticks;
+    }
+
+    // Halving every bucket keeps the shape of the histogram
+    uint16_t *bucket = &stats->buckets[profiler_bucket(ticks)];
+    if (*bucket == UINT16_MAX) {
+        for (uint8_t i = 0; i < PROFILER_BUCKETS; i++) {
+            stats->buckets[i] >>= 1;
+        }
+    }
+    (*bucket)++;
+}
+
+static profiler_ticks_t profiler_p99(const profiler_stats_t *stats) {
+    uint32_t samples = 0;
+    for (uint8_t i = 0; i < PROFILER_BUCKETS; i++) {
+        samples += stats->buckets[i];
+    }
+
+    // Find the bucket holding the sample that has 1% of the samples above it
+    uint32_t         above = 0;
+    profiler_ticks_t p99   = stats->max;
+    for (uint8_t i = PROFILER_BUCKETS; i-- > 0;) {
+        above += stats->buckets[i];
+        if (above > samples / 100) {
+            if (i < PROFILER_BUCKETS - 1) {
+                p99 = ((profiler_ticks_t)2 << i) - 1;
+            }
+            break;
+        }
+    }
+    if (p99 > stats->max) {
+        p99 = stats->max;
+    }
+    if (p99 < stats->min) {
+        p99 = stats->min;
+    }
+    return p99;
+}
+
+void profiler_summary(profiler_probe_t probe, profiler_summary_t *summary) {
+    const profiler_stats_t *stats = &profiler_stats[probe];
+
+    summary->count = stats->count;
+    if (!stats->count) {
+        summary->min = summary->avg = summary->max = summary->p99 = 0;
+        return;
+    }
+    summary->min = profiler_ticks_to_us(stats->min);
+    summary->avg = profiler_ticks_to_us(stats->total / stats->total_count);
+    summary->max = profiler_ticks_to_us(stats->max);
+    summary->p99 = profiler_ticks_to_us(profiler_p99(stats));
+}
+
+void profiler_reset(void) {
+    for (uint8_t probe = 0; probe < PROFILER_PROBE_COUNT; probe++) {
+        profiler_stats_t *stats = &profiler_stats[probe];
+
+        stats->count       = 0;
+        stats->total       = 0;
+        stats->total_count = 0;
+        stats->min         = UINT32_MAX;
+        stats->max         = 0;
+        for (uint8_t i = 0; i < PROFILER_BUCKETS; i++) {
+            stats->buckets[i] = 0;
+        }
+    }
+}
+
+void profiler_print(void) {
+#ifdef CONSOLE_ENABLE
+    profiler_summary_t summary;
+    for (uint8_t probe = 0; probe < PROFILER_PROBE_COUNT; probe++) {
+        profiler_summary(probe, &summary);
+        if (!summary.count) {
+            continue;
+        }
+        if (probe < PROFILER_USER) {
+            xprintf("%s", profiler_names[probe]);
+        } else {
+            xprintf("user %u", probe - PROFILER_USER);
+        }
+        xprintf(": %lu calls, min %lu avg %lu max %lu p99 %lu us\n", (unsigned long)summary.count, (unsigned long)summary.min, (unsigned long)summary.avg, (unsigned long)summary.max, (unsigned long)summary.p99);
+    }
+#endif
+}
+
+static uint8_t profiler_put32(uint8_t *data, uint32_t value) {
+    for (uint8_t i = 0; i < 4; i++) {
+        data[i] = value >> (i * 8);
+    }
+    return 4;
+}
+
+uint8_t profiler_raw_hid_report(profiler_probe_t probe, uint8_t *data, uint8_t length) {
+    if (length < PROFILER_RAW_HID_REPORT_SIZE || probe >= PROFILER_PROBE_COUNT) {
+        return 0;
+    }
+
+    profiler_summary_t summary;
+    profiler_summary(probe, &summary);
+
+    uint8_t size = 0;
+    data[size++] = probe;
+    size += profiler_put32(&data[size], summary.count);
+    size += profiler_put32(&data[size], summary.min);
+    size += profiler_put32(&data[size], summary.avg);
+    size += profiler_put32(&data[size], summary.max);
+    size += profiler_put32(&data[size], summary.p99);
+    return size;
+}
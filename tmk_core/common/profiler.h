@@ -0,0 +1,90 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    PROFILER_MATRIX_SCAN,
+    PROFILER_ACTION_EXEC,
+    PROFILER_RGB_MATRIX_TASK,
+    PROFILER_OLED_TASK,
+    PROFILER_SEND_KEYBOARD,
+    PROFILER_USER,  // first of PROFILER_USER_PROBES probes for keymaps
+} profiler_probe_t;
+
+#ifndef PROFILER_USER_PROBES
+#    define PROFILER_USER_PROBES 0
+#endif
+
+#define PROFILER_PROBE_COUNT (PROFILER_USER + PROFILER_USER_PROBES)
+
+// Report interval in milliseconds, 0 disables reporting to the console
+#ifndef PROFILER_REPORT_INTERVAL
+#    define PROFILER_REPORT_INTERVAL 1000
+#endif
+
+// Power of two buckets, the last one counts everything above
+#ifndef PROFILER_BUCKETS
+#    define PROFILER_BUCKETS 24
+#endif
+
+// Length of the raw HID report built by profiler_raw_hid_report()
+#define PROFILER_RAW_HID_REPORT_SIZE 21
+
+typedef uint32_t profiler_ticks_t;
+
+// Durations in microseconds
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t avg;
+    uint32_t max;
+    uint32_t p99;
+} profiler_summary_t;
+
+#ifdef PROFILER_ENABLE
+#    define PROFILE_START(name) profiler_ticks_t profile_start_##name = profiler_read()
+#    define PROFILE_END(name, probe) profiler_record(probe, profiler_read() - profile_start_##name)
+#else
+#    define PROFILE_START(name)
+#    define PROFILE_END(name, probe)
+#endif
+
+void profiler_init(void);
+void profiler_task(void);
+
+/* free running clock, see PROFILER_CLOCK_HZ in profiler.c */
+profiler_ticks_t profiler_read(void);
+uint32_t         profiler_ticks_to_us(profiler_ticks_t ticks);
+
+void profiler_record(profiler_probe_t probe, profiler_ticks_t ticks);
+void profiler_summary(profiler_probe_t probe, profiler_summary_t *summary);
+void profiler_reset(void);
+void profiler_print(void);
+
+/* fills data with the probe number followed by the count, min, avg, max and p99 as little endian */
+uint8_t profiler_raw_hid_report(profiler_probe_t probe, uint8_t *data, uint8_t length);
+
+#ifdef __cplusplus
+}
+#endif
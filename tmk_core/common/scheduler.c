@@ -0,0 +1,115 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stddef.h>
+#include "scheduler.h"
+#include "timer.h"
+
+// The slots are tracked in a uint32_t while the tasks run
+_Static_assert(SCHEDULER_MAX_TASKS <= 32, "SCHEDULER_MAX_TASKS can't be more than 32");
+_Static_assert(SCHEDULER_MAX_TASKS >= SCHEDULER_BUILTIN_TASKS, "SCHEDULER_MAX_TASKS leaves no room for the built in tasks of the enabled features");
+
+typedef struct {
+    task_func_t func;  // NULL for a free slot
+    uint16_t    period;
+    uint16_t    deadline;
+    uint16_t    next_run;
+    uint8_t     priority;
+} scheduler_entry_t;
+
+static scheduler_entry_t scheduler_tasks[SCHEDULER_MAX_TASKS];
+static uint8_t           scheduler_last;
+
+void scheduler_init(void) {
+    for (uint8_t i = 0; i < SCHEDULER_MAX_TASKS; i++) {
+        scheduler_tasks[i].func = NULL;
+    }
+}
+
+task_id_t scheduler_add_task(task_func_t func, uint16_t period, uint16_t deadline, task_priority_t priority) {
+    for (uint8_t i = 0; i < SCHEDULER_MAX_TASKS; i++) {
+        scheduler_entry_t *task = &scheduler_tasks[i];
+        if (!task->func) {
+            task->func     = func;
+            task->period   = period;
+            task->deadline = deadline;
+            task->priority = priority;
+            task->next_run = timer_read();
+            return i;
+        }
+    }
+    return INVALID_TASK_ID;
+}
+
+void scheduler_remove_task(task_id_t id) {
+    if (id < SCHEDULER_MAX_TASKS) {
+        scheduler_tasks[id].func = NULL;
+    }
+}
+
+void scheduler_set_period(task_id_t id, uint16_t period) {
+    if (id < SCHEDULER_MAX_TASKS) {
+        scheduler_tasks[id].period = period;
+    }
+}
+
+static void scheduler_run(scheduler_entry_t *task, uint16_t now) {
+    task->func();
+
+    // Keep to the period, unless we have fallen a whole period behind
+    task->next_run += task->period;
+    if (timer_expired(now, task->next_run)) {
+        task->next_run = now + task->period;
+    }
+}
+
+void scheduler_task(bool busy) {
+    uint16_t now = timer_read();
+    uint32_t ran = 0;
+
+    // High priority tasks and those past their deadline can't wait
+    for (uint8_t i = 0; i < SCHEDULER_MAX_TASKS; i++) {
+        scheduler_entry_t *task = &scheduler_tasks[i];
+        if (task->func && timer_expired(now, task->next_run) && (task->priority == TASK_PRIORITY_HIGH || TIMER_DIFF_16(now, task->next_run) >= task->deadline)) {
+            scheduler_run(task, now);
+            ran |= (uint32_t)1 << i;
+        }
+    }
+
+    // The others are spread over the loops where no keys were handled, highest
+    // priority first, then the one that has waited the longest, then in turns
+    for (uint8_t budget = busy ? 0 : SCHEDULER_TASKS_PER_LOOP; budget > 0; budget--) {
+        scheduler_entry_t *next = NULL;
+        uint8_t            next_index = 0;
+        for (uint8_t n = 1; n <= SCHEDULER_MAX_TASKS; n++) {
+            uint8_t            i    = (scheduler_last + n) % SCHEDULER_MAX_TASKS;
+            scheduler_entry_t *task = &scheduler_tasks[i];
+            if (!task->func || (ran & ((uint32_t)1 << i)) || !timer_expired(now, task->next_run)) {
+                continue;
+            }
+            if (!next || task->priority < next->priority || (task->priority == next->priority && TIMER_DIFF_16(now, task->next_run) > TIMER_DIFF_16(now, next->next_run))) {
+                next       = task;
+                next_index = i;
+            }
+        }
+        if (!next) {
+            break;
+        }
+        scheduler_run(next, now);
+        ran |= (uint32_t)1 << next_index;
+        scheduler_last = next_index;
+    }
+}
@@ -0,0 +1,115 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// One slot for each built in task keyboard_add_tasks() registers
+enum scheduler_builtin_tasks {
+#ifdef PROFILER_ENABLE
+    SCHEDULER_PROFILER_TASK,
+#endif
+#if defined(RGBLIGHT_ENABLE)
+    SCHEDULER_RGBLIGHT_TASK,
+#endif
+#if defined(BACKLIGHT_ENABLE) && (defined(BACKLIGHT_PIN) || defined(BACKLIGHT_PINS))
+    SCHEDULER_BACKLIGHT_TASK,
+#endif
+#ifdef ENCODER_ENABLE
+    SCHEDULER_ENCODER_TASK,
+#endif
+#ifdef QWIIC_ENABLE
+    SCHEDULER_QWIIC_TASK,
+#endif
+#ifdef OLED_DRIVER_ENABLE
+    SCHEDULER_OLED_TASK,
+#endif
+#ifdef MOUSEKEY_ENABLE
+    SCHEDULER_MOUSEKEY_TASK,
+#endif
+#ifdef PS2_MOUSE_ENABLE
+    SCHEDULER_PS2_MOUSE_TASK,
+#endif
+#ifdef SERIAL_MOUSE_ENABLE
+    SCHEDULER_SERIAL_MOUSE_TASK,
+#endif
+#ifdef ADB_MOUSE_ENABLE
+    SCHEDULER_ADB_MOUSE_TASK,
+#endif
+#ifdef SERIAL_LINK_ENABLE
+    SCHEDULER_SERIAL_LINK_TASK,
+#endif
+#ifdef VISUALIZER_ENABLE
+    SCHEDULER_VISUALIZER_TASK,
+#endif
+#ifdef POINTING_DEVICE_ENABLE
+    SCHEDULER_POINTING_DEVICE_TASK,
+#endif
+#ifdef MIDI_ENABLE
+    SCHEDULER_MIDI_TASK,
+#endif
+#ifdef VELOCIKEY_ENABLE
+    SCHEDULER_VELOCIKEY_TASK,
+#endif
+#ifdef JOYSTICK_ENABLE
+    SCHEDULER_JOYSTICK_TASK,
+#endif
+    SCHEDULER_BUILTIN_TASKS
+};
+
+// Free slots for the tasks of keyboards and keymaps
+#ifndef SCHEDULER_USER_TASKS
+#    define SCHEDULER_USER_TASKS 8
+#endif
+
+#ifndef SCHEDULER_MAX_TASKS
+#    define SCHEDULER_MAX_TASKS (SCHEDULER_BUILTIN_TASKS + SCHEDULER_USER_TASKS)
+#endif
+
+// Normal and low priority tasks run per loop, unless they are past their deadline
+#ifndef SCHEDULER_TASKS_PER_LOOP
+#    define SCHEDULER_TASKS_PER_LOOP 1
+#endif
+
+typedef enum {
+    TASK_PRIORITY_HIGH,  // runs whenever it is due
+    TASK_PRIORITY_NORMAL,
+    TASK_PRIORITY_LOW,
+} task_priority_t;
+
+typedef void (*task_func_t)(void);
+typedef uint8_t task_id_t;
+
+#define INVALID_TASK_ID 0xFF
+
+/* runs func every period ms, and no later than deadline ms after it became due */
+task_id_t scheduler_add_task(task_func_t func, uint16_t period, uint16_t deadline, task_priority_t priority);
+void      scheduler_remove_task(task_id_t id);
+void      scheduler_set_period(task_id_t id, uint16_t period);
+
+void scheduler_init(void);
+/* busy means key events were handled in this loop, so only urgent tasks run */
+void scheduler_task(bool busy);
+
+#ifdef __cplusplus
+}
+#endif
@@ -15,6 +15,11 @@ VPATH += $(TMK_PATH)/$(CHIBIOS_DIR)/lufa_utils
 OPT_DEFS += -DFIXED_CONTROL_ENDPOINT_SIZE=64
 OPT_DEFS += -DFIXED_NUM_CONFIGURATIONS=1
 
+ifeq ($(strip $(USB_REPORT_QUEUE_ENABLE)), yes)
+  OPT_DEFS += -DUSB_REPORT_QUEUE_ENABLE
+  SRC += report_queue.c
+endif
+
 ifeq ($(strip $(MIDI_ENABLE)), yes)
   include $(TMK_PATH)/protocol/midi.mk
 endif
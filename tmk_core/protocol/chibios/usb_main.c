@@ -40,6 +40,9 @@
 #include "wait.h"
 #include "usb_descriptor.h"
 #include "usb_driver.h"
+#ifdef USB_REPORT_QUEUE_ENABLE
+#    include "report_queue.h"
+#endif
 
 #ifdef NKRO_ENABLE
 #    include "keycode_config.h"
@@ -79,6 +82,92 @@ report_mouse_t mouse_report_blank = {0};
 uint8_t extra_report_blank[3] = {0};
 #endif /* EXTRAKEY_ENABLE */
 
+/* ---------------------------------------------------------
+ *                    IN report queues
+ * ---------------------------------------------------------
+ */
+
+#ifdef USB_REPORT_QUEUE_ENABLE
+
+/* Reports are queued per endpoint, so a burst of them doesn't hold up the
+ * keyboard task. The IN callback starts the next one when a report is sent. */
+
+/* called from an IN callback or a locked thread */
+static bool transmit_report(usbep_t ep, const uint8_t *data, uint8_t length) {
+    if (usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE || usbGetTransmitStatusI(&USB_DRIVER, ep)) {
+        return false;
+    }
+    usbStartTransmitI(&USB_DRIVER, ep, (uint8_t *)data, length);
+    return true;
+}
+
+#    ifndef KEYBOARD_SHARED_EP
+static bool kbd_transmit(const uint8_t *data, uint8_t length) { return transmit_report(KEYBOARD_IN_EPNUM, data, length); }
+REPORT_QUEUE(kbd_queue, KEYBOARD_EPSIZE, kbd_transmit);
+#        define KEYBOARD_QUEUE (&kbd_queue)
+#    else
+#        define KEYBOARD_QUEUE (&shared_queue)
+#    endif
+
+#    if defined(MOUSE_ENABLE) && !defined(MOUSE_SHARED_EP)
+static bool mouse_transmit(const uint8_t *data, uint8_t length) { return transmit_report(MOUSE_IN_EPNUM, data, length); }
+REPORT_QUEUE(mouse_queue, MOUSE_EPSIZE, mouse_transmit);
+#        define MOUSE_QUEUE (&mouse_queue)
+#    else
+#        define MOUSE_QUEUE (&shared_queue)
+#    endif
+
+#    ifdef SHARED_EP_ENABLE
+static bool shared_transmit(const uint8_t *data, uint8_t length) { return transmit_report(SHARED_IN_EPNUM, data, length); }
+REPORT_QUEUE(shared_queue, SHARED_EPSIZE, shared_transmit);
+#    endif
+
+/* the endpoints were reset, so the reports being sent are gone */
+static void clear_report_queues(void) {
+#    ifndef KEYBOARD_SHARED_EP
+    report_queue_clear(&kbd_queue);
+#    endif
+#    if defined(MOUSE_ENABLE) && !defined(MOUSE_SHARED_EP)
+    report_queue_clear(&mouse_queue);
+#    endif
+#    ifdef SHARED_EP_ENABLE
+    report_queue_clear(&shared_queue);
+#    endif
+}
+
+/* waits for the IN callback to make room, returns false if USB went away
+ * not callable from ISR or locked state */
+static bool wait_for_room(report_queue_t *queue, usbep_t ep) {
+    osalSysLock();
+    if (report_queue_count(queue) >= USB_REPORT_QUEUE_SIZE) {
+        /* Note: for suspend, need USB_USE_WAIT == TRUE in halconf.h */
+        osalThreadSuspendTimeoutS(&(&USB_DRIVER)->epc[ep]->in_state->thread, TIME_MS2I(10));
+    }
+    bool active = usbGetDriverStateI(&USB_DRIVER) == USB_ACTIVE;
+    osalSysUnlock();
+    return active;
+}
+
+/* not callable from ISR or locked state */
+static void send_report(report_queue_t *queue, usbep_t ep, const void *report, uint8_t length) {
+    if (usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
+        return;
+    }
+    /* the queue itself is lock free, only starting a transfer needs the lock */
+    while (!report_queue_push(queue, report, length)) {
+        if (!wait_for_room(queue, ep)) {
+            return;
+        }
+    }
+    osalSysLock();
+    report_queue_start(queue);
+    osalSysUnlock();
+}
+
+#else
+#    define clear_report_queues()
+#endif
+
 /* ---------------------------------------------------------
  *            Descriptors and USB driver objects
  * ---------------------------------------------------------
@@ -387,6 +476,7 @@ static void usb_event_cb(USBDriver *usbp, usbevent_t event) {
 #ifdef SHARED_EP_ENABLE
             usbInitEndpointI(usbp, SHARED_IN_EPNUM, &shared_ep_config);
 #endif
+            clear_report_queues();
             for (int i = 0; i < NUM_USB_DRIVERS; i++) {
 #if STM32_USB_USE_OTG1
                 usbInitEndpointI(usbp, drivers.array[i].config.bulk_in, &drivers.array[i].inout_ep_config);
@@ -409,6 +499,11 @@ static void usb_event_cb(USBDriver *usbp, usbevent_t event) {
         case USB_EVENT_UNCONFIGURED:
             /* Falls into.*/
         case USB_EVENT_RESET:
+#ifdef USB_REPORT_QUEUE_ENABLE
+            osalSysLockFromISR();
+            clear_report_queues();
+            osalSysUnlockFromISR();
+#endif
             for (int i = 0; i < NUM_USB_DRIVERS; i++) {
                 chSysLockFromISR();
                 /* Disconnection event on suspend.*/
@@ -662,9 +757,13 @@ void restart_usb_driver(USBDriver *usbp) {
 /* keyboard IN callback hander (a kbd report has made it IN) */
 #ifndef KEYBOARD_SHARED_EP
 void kbd_in_cb(USBDriver *usbp, usbep_t ep) {
-    /* STUB */
     (void)usbp;
     (void)ep;
+#    ifdef USB_REPORT_QUEUE_ENABLE
+    osalSysLockFromISR();
+    report_queue_sent(&kbd_queue);
+    osalSysUnlockFromISR();
+#    endif
 }
 #endif
 
@@ -693,7 +792,12 @@ static void keyboard_idle_timer_cb(void *arg) {
     if (keyboard_idle && keyboard_protocol) {
 #endif /* NKRO_ENABLE */
         /* TODO: are we sure we want the KBD_ENDPOINT? */
+#ifdef USB_REPORT_QUEUE_ENABLE
+        /* queued reports are newer anyway */
+        if (!usbGetTransmitStatusI(usbp, KEYBOARD_IN_EPNUM) && !report_queue_count(KEYBOARD_QUEUE)) {
+#else
         if (!usbGetTransmitStatusI(usbp, KEYBOARD_IN_EPNUM)) {
+#endif
             usbStartTransmitI(usbp, KEYBOARD_IN_EPNUM, (uint8_t *)&keyboard_report_sent, KEYBOARD_EPSIZE);
         }
         /* rearm the timer */
@@ -708,6 +812,29 @@ static void keyboard_idle_timer_cb(void *arg) {
 /* LED status */
 uint8_t keyboard_leds(void) { return keyboard_led_state; }
 
+#ifdef USB_REPORT_QUEUE_ENABLE
+/* queue a report to be sent IN
+ * not callable from ISR or locked state */
+void send_keyboard(report_keyboard_t *report) {
+#    ifdef NKRO_ENABLE
+    if (keymap_config.nkro && keyboard_protocol) { /* NKRO protocol */
+        send_report(&shared_queue, SHARED_IN_EPNUM, report, sizeof(struct nkro_report));
+    } else
+#    endif /* NKRO_ENABLE */
+    {  /* regular protocol */
+        uint8_t *data, size;
+        if (keyboard_protocol) {
+            data = (uint8_t *)report;
+            size = KEYBOARD_REPORT_SIZE;
+        } else { /* boot protocol */
+            data = &report->mods;
+            size = 8;
+        }
+        send_report(KEYBOARD_QUEUE, KEYBOARD_IN_EPNUM, data, size);
+    }
+    keyboard_report_sent = *report;
+}
+#else
 /* prepare and start sending a report IN
  * not callable from ISR or locked state */
 void send_keyboard(report_keyboard_t *report) {
@@ -716,7 +843,7 @@ void send_keyboard(report_keyboard_t *report) {
         goto unlock;
     }
 
-#ifdef NKRO_ENABLE
+#    ifdef NKRO_ENABLE
     if (keymap_config.nkro && keyboard_protocol) { /* NKRO protocol */
         /* need to wait until the previous packet has made it through */
         /* can rewrite this using the synchronous API, then would wait
@@ -737,7 +864,7 @@ void send_keyboard(report_keyboard_t *report) {
         }
         usbStartTransmitI(&USB_DRIVER, SHARED_IN_EPNUM, (uint8_t *)report, sizeof(struct nkro_report));
     } else
-#endif /* NKRO_ENABLE */
+#    endif /* NKRO_ENABLE */
     {  /* regular protocol */
         /* need to wait until the previous packet has made it through */
         /* busy wait, should be short and not very common */
@@ -768,6 +895,7 @@ void send_keyboard(report_keyboard_t *report) {
 unlock:
     osalSysUnlock();
 }
+#endif
 
 /* ---------------------------------------------------------
  *                     Mouse functions
@@ -781,9 +909,30 @@ unlock:
 void mouse_in_cb(USBDriver *usbp, usbep_t ep) {
     (void)usbp;
     (void)ep;
+#        ifdef USB_REPORT_QUEUE_ENABLE
+    osalSysLockFromISR();
+    report_queue_sent(&mouse_queue);
+    osalSysUnlockFromISR();
+#        endif
 }
 #    endif
 
+#    ifdef USB_REPORT_QUEUE_ENABLE
+void send_mouse(report_mouse_t *report) {
+    bool queued;
+    do {
+        /* movement is added to a report still waiting, which the IN callback mustn't pick up meanwhile */
+        osalSysLock();
+        if (usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
+            osalSysUnlock();
+            return;
+        }
+        queued = report_queue_push_mouse(MOUSE_QUEUE, report);
+        report_queue_start(MOUSE_QUEUE);
+        osalSysUnlock();
+    } while (!queued && wait_for_room(MOUSE_QUEUE, MOUSE_IN_EPNUM));
+}
+#    else
 void send_mouse(report_mouse_t *report) {
     osalSysLock();
     if (usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
@@ -804,6 +953,7 @@ void send_mouse(report_mouse_t *report) {
     usbStartTransmitI(&USB_DRIVER, MOUSE_IN_EPNUM, (uint8_t *)report, sizeof(report_mouse_t));
     osalSysUnlock();
 }
+#    endif
 
 #else  /* MOUSE_ENABLE */
 void   send_mouse(report_mouse_t *report) { (void)report; }
@@ -816,9 +966,13 @@ void   send_mouse(report_mouse_t *report) { (void)report; }
 #ifdef SHARED_EP_ENABLE
 /* shared IN callback hander */
 void shared_in_cb(USBDriver *usbp, usbep_t ep) {
-    /* STUB */
     (void)usbp;
     (void)ep;
+#    ifdef USB_REPORT_QUEUE_ENABLE
+    osalSysLockFromISR();
+    report_queue_sent(&shared_queue);
+    osalSysUnlockFromISR();
+#    endif
 }
 #endif
 
@@ -828,6 +982,13 @@ void shared_in_cb(USBDriver *usbp, usbep_t ep) {
  */
 
 #ifdef EXTRAKEY_ENABLE
+#    ifdef USB_REPORT_QUEUE_ENABLE
+static void send_extra(uint8_t report_id, uint16_t data) {
+    report_extra_t report = {.report_id = report_id, .usage = data};
+
+    send_report(&shared_queue, SHARED_IN_EPNUM, &report, sizeof(report_extra_t));
+}
+#    else
 static void send_extra(uint8_t report_id, uint16_t data) {
     osalSysLock();
     if (usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE) {
@@ -840,6 +1001,7 @@ static void send_extra(uint8_t report_id, uint16_t data) {
     usbStartTransmitI(&USB_DRIVER, SHARED_IN_EPNUM, (uint8_t *)&report, sizeof(report_extra_t));
     osalSysUnlock();
 }
+#    endif
 #endif
 
 void send_system(uint16_t data) {
@@ -0,0 +1,118 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include "report_queue.h"
+
+#if (USB_REPORT_QUEUE_SIZE & (USB_REPORT_QUEUE_SIZE - 1)) || USB_REPORT_QUEUE_SIZE > 128
+#    error "USB_REPORT_QUEUE_SIZE must be a power of two, up to 128"
+#endif
+
+// The report has to be in its slot before the consumer can see the new head
+#define COMPILER_BARRIER() __asm__ volatile("" ::: "memory")
+
+static uint8_t *queue_slot(const report_queue_t *queue, uint8_t index) { return &queue->slots[(index & (queue->capacity - 1)) * queue->slot_size]; }
+
+uint8_t report_queue_count(const report_queue_t *queue) { return queue->head - queue->tail; }
+
+static bool queue_add(report_queue_t *queue, const void *report, uint8_t length) {
+    uint8_t head = queue->head;
+
+    if (length >= queue->slot_size || (uint8_t)(head - queue->tail) >= queue->capacity) {
+        return false;
+    }
+
+    uint8_t *slot = queue_slot(queue, head);
+    slot[0]       = length;
+    memcpy(&slot[1], report, length);
+    COMPILER_BARRIER();
+    queue->head = head + 1;
+    return true;
+}
+
+bool report_queue_push(report_queue_t *queue, const void *report, uint8_t length) {
+    // The slot is only reused by us, so it still holds the report even if it was sent meanwhile
+    if (queue->head != queue->tail) {
+        uint8_t *last = queue_slot(queue, queue->head - 1);
+        if (last[0] == length && !memcmp(&last[1], report, length)) {
+            return true;
+        }
+    }
+    return queue_add(queue, report, length);
+}
+
+static bool merge_axis(int8_t *queued, int8_t delta) {
+    int16_t sum = *queued + delta;
+    if (sum < -127 || sum > 127) {
+        return false;
+    }
+    *queued = sum;
+    return true;
+}
+
+static bool merge_mouse_report(report_mouse_t *queued, const report_mouse_t *report) {
+#ifdef MOUSE_SHARED_EP
+    if (queued->report_id != report->report_id) {
+        return false;
+    }
+#endif
+    if (queued->buttons != report->buttons) {
+        return false;
+    }
+
+    report_mouse_t merged = *queued;
+    if (!merge_axis(&merged.x, report->x) || !merge_axis(&merged.y, report->y) || !merge_axis(&merged.v, report->v) || !merge_axis(&merged.h, report->h)) {
+        return false;
+    }
+    *queued = merged;
+    return true;
+}
+
+bool report_queue_push_mouse(report_queue_t *queue, const report_mouse_t *report) {
+    // The report being sent can't be changed any more
+    if (report_queue_count(queue) > (queue->sending ? 1 : 0)) {
+        uint8_t *last = queue_slot(queue, queue->head - 1);
+        if (last[0] == sizeof(report_mouse_t) && merge_mouse_report((report_mouse_t *)&last[1], report)) {
+            return true;
+        }
+    }
+    // Movement adds up, so only a report without any can be skipped
+    if (report->x || report->y || report->v || report->h) {
+        return queue_add(queue, report, sizeof(report_mouse_t));
+    }
+    return report_queue_push(queue, report, sizeof(report_mouse_t));
+}
+
+void report_queue_start(report_queue_t *queue) {
+    if (!queue->sending && queue->head != queue->tail) {
+        uint8_t *slot  = queue_slot(queue, queue->tail);
+        queue->sending = queue->transmit(&slot[1], slot[0]);
+    }
+}
+
+void report_queue_sent(report_queue_t *queue) {
+    // Reports sent around the queue, like idle repeats, only make room for the next one
+    if (queue->sending) {
+        queue->tail++;
+        queue->sending = false;
+    }
+    report_queue_start(queue);
+}
+
+void report_queue_clear(report_queue_t *queue) {
+    queue->tail    = queue->head;
+    queue->sending = false;
+}
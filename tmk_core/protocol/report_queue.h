@@ -0,0 +1,71 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "report.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Reports waiting for an IN endpoint, must be a power of two */
+#ifndef USB_REPORT_QUEUE_SIZE
+#    define USB_REPORT_QUEUE_SIZE 8
+#endif
+
+/* starts sending a report, returns false if the endpoint is still busy */
+typedef bool (*report_queue_transmit_t)(const uint8_t *data, uint8_t length);
+
+/* Single producer, single consumer queue of reports for one endpoint. The
+ * keyboard task pushes, and the IN callback pops once a report has been sent.
+ * The report being sent stays in its slot until then.
+ */
+typedef struct {
+    uint8_t *               slots;  // each slot holds the report length, then the report
+    report_queue_transmit_t transmit;
+    uint8_t                 slot_size;
+    uint8_t                 capacity;
+    volatile uint8_t        head;  // only moved by the producer
+    volatile uint8_t        tail;  // only moved by the consumer
+    volatile bool           sending;
+} report_queue_t;
+
+#define REPORT_QUEUE(name, report_size, transmit_fn)                                           \
+    static uint8_t        name##_slots[USB_REPORT_QUEUE_SIZE * ((report_size) + 1)];           \
+    static report_queue_t name = {name##_slots, transmit_fn, (report_size) + 1, USB_REPORT_QUEUE_SIZE, 0, 0, false}
+
+/* Producer side, both return false if the queue is full */
+/* skips a report that is the same as the last one queued */
+bool report_queue_push(report_queue_t *queue, const void *report, uint8_t length);
+/* adds the movement to the last mouse report queued if it hasn't been sent yet
+ * and has the same buttons, so the consumer must not run during the call */
+bool report_queue_push_mouse(report_queue_t *queue, const report_mouse_t *report);
+
+/* Consumer side, or the producer while the consumer can't run */
+void report_queue_start(report_queue_t *queue);
+/* the report being sent has made it IN, start the next one */
+void report_queue_sent(report_queue_t *queue);
+/* drops everything queued, for when the endpoint is reset */
+void report_queue_clear(report_queue_t *queue);
+
+uint8_t report_queue_count(const report_queue_t *queue);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,142 @@
+/* Copyright 2021 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <vector>
+
+extern "C" {
+#include "report_queue.h"
+}
+
+// Stands in for an IN endpoint, busy from the start of a transfer until the host polls it
+static bool                              endpoint_busy = false;
+static std::vector<std::vector<uint8_t>> sent;
+
+static bool fake_transmit(const uint8_t *data, uint8_t length) {
+    if (endpoint_busy) {
+        return false;
+    }
+    endpoint_busy = true;
+    sent.push_back(std::vector<uint8_t>(data, data + length));
+    return true;
+}
+
+REPORT_QUEUE(queue, 8, fake_transmit);
+
+class ReportQueue : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        report_queue_clear(&queue);
+        endpoint_busy = false;
+        sent.clear();
+    }
+
+    void send(std::vector<uint8_t> report) {
+        EXPECT_TRUE(report_queue_push(&queue, report.data(), report.size()));
+        report_queue_start(&queue);
+    }
+
+    void send_mouse(uint8_t buttons, int8_t x, int8_t y) {
+        report_mouse_t report = {.buttons = buttons, .x = x, .y = y};
+        EXPECT_TRUE(report_queue_push_mouse(&queue, &report));
+        report_queue_start(&queue);
+    }
+
+    // The host has polled the endpoint
+    void poll() {
+        endpoint_busy = false;
+        report_queue_sent(&queue);
+    }
+};
+
+TEST_F(ReportQueue, BurstIsSentOnePollAtATime) {
+    send({1});
+    send({2});
+    send({3});
+    EXPECT_EQ(sent, std::vector<std::vector<uint8_t>>({{1}}));
+    EXPECT_EQ(report_queue_count(&queue), 3);
+
+    poll();
+    poll();
+    EXPECT_EQ(sent, std::vector<std::vector<uint8_t>>({{1}, {2}, {3}}));
+    poll();
+    EXPECT_EQ(report_queue_count(&queue), 0);
+    EXPECT_FALSE(endpoint_busy);
+}
+
+TEST_F(ReportQueue, RepeatedReportsAreSkipped) {
+    send({1, 2});
+    send({1, 2});
+    send({3, 4});
+    send({3, 4});
+    send({3});
+    poll();
+    poll();
+    poll();
+    EXPECT_EQ(sent, std::vector<std::vector<uint8_t>>({{1, 2}, {3, 4}, {3}}));
+}
+
+TEST_F(ReportQueue, FullQueueRefusesReports) {
+    for (uint8_t i = 0; i < USB_REPORT_QUEUE_SIZE; i++) {
+        send({i});
+    }
+    uint8_t extra = 0xFF;
+    EXPECT_FALSE(report_queue_push(&queue, &extra, 1));
+    // too long for a slot
+    uint8_t long_report[9] = {0};
+    poll();
+    EXPECT_FALSE(report_queue_push(&queue, long_report, sizeof(long_report)));
+    EXPECT_TRUE(report_queue_push(&queue, &extra, 1));
+}
+
+TEST_F(ReportQueue, BusyEndpointIsRetriedWhenPolled) {
+    // Something else, like an idle repeat, is using the endpoint
+    endpoint_busy = true;
+    send({1});
+    EXPECT_TRUE(sent.empty());
+    poll();
+    EXPECT_EQ(sent, std::vector<std::vector<uint8_t>>({{1}}));
+}
+
+TEST_F(ReportQueue, MouseMovementIsAddedUp) {
+    send_mouse(0, 1, 1);
+    // The first one is already being sent, so these are added up instead
+    send_mouse(0, 2, -1);
+    send_mouse(0, 3, -1);
+    send_mouse(1, 0, 0);
+    send_mouse(1, 100, 0);
+    send_mouse(1, 100, 0);
+    EXPECT_EQ(report_queue_count(&queue), 4);
+
+    for (int i = 0; i < 4; i++) {
+        poll();
+    }
+    ASSERT_EQ(sent.size(), 4u);
+    EXPECT_EQ(sent[1], std::vector<uint8_t>({0, 5, (uint8_t)-2, 0, 0}));
+    EXPECT_EQ(sent[2], std::vector<uint8_t>({1, 100, 0, 0, 0}));
+    EXPECT_EQ(sent[3], std::vector<uint8_t>({1, 100, 0, 0, 0}));
+}
+
+TEST_F(ReportQueue, ClearDropsWaitingReports) {
+    send({1});
+    send({2});
+    report_queue_clear(&queue);
+    endpoint_busy = false;
+    poll();
+    EXPECT_EQ(sent, std::vector<std::vector<uint8_t>>({{1}}));
+    send({3});
+    EXPECT_EQ(sent, std::vector<std::vector<uint8_t>>({{1}, {3}}));
+}
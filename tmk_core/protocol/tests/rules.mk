@@ -0,0 +1,7 @@
+usb_report_queue_INC := \
+	$(TMK_PATH)/protocol \
+	$(TMK_PATH)/common
+
+usb_report_queue_SRC := \
+	$(TMK_PATH)/protocol/tests/report_queue_tests.cpp \
+	$(TMK_PATH)/protocol/report_queue.c